@@ -0,0 +1,76 @@
+#include "BatchMode.h"
+#include "Benchmark.h"
+#include "SoupSearch.h"
+#include "Rule.h"
+#include "CellKernel.h"
+#include "ThreadPool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Up to 3 numbers after argv[argIdx], stops at the next option
+static void ParseValues(int argc, char** argv, int argIdx, int* values)
+{
+    for (int i = 0; i < 3 && argIdx + 1 + i < argc && argv[argIdx + 1 + i][0] != '-'; i++)
+        values[i] = atoi(argv[argIdx + 1 + i]);
+}
+
+bool RunBatchMode(int argc, char** argv, int* exitCode)
+{
+    int numThreads = 0;
+    int benchArg = 0;
+    int soupArg = 0;
+    const char* soupFile = SOUP_FILE;
+    const char* mergeFile = NULL;
+    const char* rulestring = "B3/S23";
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            numThreads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--rule") == 0 && i + 1 < argc)
+            rulestring = argv[++i];
+        else if (strcmp(argv[i], "--bench") == 0)
+            benchArg = i;
+        else if (strcmp(argv[i], "--soups") == 0 && i + 1 < argc)
+            soupArg = ++i;
+        else if (strcmp(argv[i], "--soup-file") == 0 && i + 1 < argc)
+            soupFile = argv[++i];
+        else if (strcmp(argv[i], "--soup-merge") == 0 && i + 1 < argc)
+            mergeFile = argv[++i];
+    }
+    if (benchArg == 0 && soupArg == 0 && mergeFile == NULL)
+        return false;
+
+    *exitCode = -1;
+    if (SetRule(rulestring) != true)
+        return true;
+    char ruleName[64];
+    FormatRule(GetRule(), ruleName, sizeof(ruleName));
+    printf("Rule : %s (%s kernel)\n", ruleName, GetRuleKernelName(GetRuleKernel()));
+    SelectCellKernel();
+
+    if (numThreads <= 0)
+        numThreads = GetDefaultThreadCount();
+
+    if (benchArg > 0)
+    {
+        int values[3] = { BENCH_X_CELLS, BENCH_Y_CELLS, BENCH_GENERATIONS };
+        ParseValues(argc, argv, benchArg, values);
+        RunBenchmark(values[0], values[1], values[2], numThreads);
+        *exitCode = 0;
+    }
+    else if (mergeFile != NULL)
+    {
+        *exitCode = MergeSoupFile(soupFile, mergeFile) ? 0 : -1;
+    }
+    else
+    {
+        unsigned long long numSoups = strtoull(argv[soupArg], NULL, 10);
+        int values[3] = { SOUP_SIZE, SOUP_SIZE, SOUP_MAX_GENERATIONS };
+        ParseValues(argc, argv, soupArg, values);
+        *exitCode = RunSoupSearch(numSoups, values[0], values[1], values[2], numThreads, soupFile) ? 0 : -1;
+    }
+
+    return true;
+}
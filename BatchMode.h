@@ -0,0 +1,9 @@
+#pragma once
+
+/*
+Runs without a board shared by the window and life_cli : --bench [w h gens], --soups N [w h gens]
+and --soup-merge FILE into --soup-file FILE, with --rule (default B3/S23) and --threads (default : all cores).
+Other options are left to the front-end, which calls RunBatchMode once its own parsing is done.
+Returns false when argv holds none of the batch options, true with exitCode set after running one.
+*/
+bool RunBatchMode(int argc, char** argv, int* exitCode);
@@ -0,0 +1,408 @@
+#include "Benchmark.h"
+#include "LifeEngine.h"
+#include "MultiUniverse.h"
+#include "ByteGrid.h"
+#include "CellKernel.h"
+#include "Memory.h"
+#include "Rule.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+
+// Seconds for the given generations, allocs receives the LifeAlloc calls made while stepping
+static double TimeEngine(LifeEngine* engine, int generations, uint64_t* allocs)
+{
+    uint64_t allocStart = GetAllocCount();
+    auto start = std::chrono::steady_clock::now();
+    for (int gen = 0; gen < generations; gen++)
+    {
+        StepEngine(engine);
+    }
+    auto stop = std::chrono::steady_clock::now();
+    *allocs = GetAllocCount() - allocStart;
+
+    return std::chrono::duration<double>(stop - start).count();
+}
+
+static size_t GetEngineBytes(const LifeEngine* engine)
+{
+    switch (engine->type)
+    {
+    case ENGINE_BYTEGRID:
+        return (size_t)engine->numXCells * engine->numYCells * sizeof(bool) * 2 +
+            engine->cellTiles.scratchSize * 2 * engine->cellTiles.numThreads * sizeof(bool);
+    case ENGINE_BITBOARD:
+        return GetBitBoardCommittedBytes(&engine->bitBoard, false);
+    case ENGINE_HASHLIFE:
+        return engine->hashLife.numNodes * sizeof(HashNode);
+    case ENGINE_SPARSE:
+        return engine->sparseLife.maxLive * sizeof(SparseCell) * 2 + engine->numXCells * sizeof(SparseColumn);
+    case ENGINE_INCREMENTAL:
+        return (size_t)engine->numXCells * engine->numYCells * (sizeof(bool) + 2 + 3 * sizeof(int));
+    case ENGINE_PADDED:
+    case ENGINE_VON_NEUMANN:
+    case ENGINE_HEXAGONAL:
+        return (size_t)engine->paddedGrid.stride * (engine->numYCells + 2) * sizeof(bool) * 2;
+    case ENGINE_GENERATIONS:
+        return (size_t)engine->generations.stride * engine->generations.numPlanes * engine->numYCells * sizeof(uint64_t) * 2;
+    case ENGINE_LARGER_THAN_LIFE:
+        return (size_t)engine->largerThanLife.stride * (engine->numYCells + 2 * engine->largerThanLife.margin) * 2 +
+            (size_t)engine->largerThanLife.numBands * 6 * (engine->largerThanLife.stride + 1) * sizeof(int);
+    case ENGINE_CHUNKED:
+        return (size_t)engine->chunkLife.numBlocks * CHUNK_POOL_BLOCK * sizeof(LifeChunk) +
+            (engine->chunkLife.tableSize + (size_t)engine->chunkLife.maxChunks * 2) * sizeof(LifeChunk*);
+    default:
+        return 0;
+    }
+}
+
+// Next states one cell at a time, the reference of the Generations and range-R rules the byte grid does not run
+static void StepReference(const uint8_t* States, uint8_t* NextStates, int numXCells, int numYCells, Rule rule)
+{
+    int range = rule.hasRange ? rule.range : 1;
+    bool isVonNeumann = rule.hasRange && rule.neighbourhood == NEIGHBOURHOOD_VON_NEUMANN;
+    for (int yidx = 0; yidx < numYCells; yidx++)
+    {
+        for (int xidx = 0; xidx < numXCells; xidx++)
+        {
+            int numNeighbours = 0;
+            for (int dy = -range; dy <= range; dy++)
+            {
+                for (int dx = -range; dx <= range; dx++)
+                {
+                    if (isVonNeumann && abs(dx) + abs(dy) > range)
+                        continue;
+                    // Window Boundary Rule of CheckRule : the cell beyond the edge is the edge cell
+                    int x = std::min(std::max(xidx + dx, 0), numXCells - 1);
+                    int y = std::min(std::max(yidx + dy, 0), numYCells - 1);
+                    if (dx != 0 || dy != 0 || rule.hasCentre)
+                        numNeighbours += States[(size_t)y * numXCells + x] == 1;
+                }
+            }
+
+            size_t idx = (size_t)yidx * numXCells + xidx;
+            uint8_t state = States[idx];
+            if (rule.hasRange)
+                NextStates[idx] = state == 1 ? numNeighbours >= rule.survivalMin && numNeighbours <= rule.survivalMax :
+                    numNeighbours >= rule.birthMin && numNeighbours <= rule.birthMax;
+            else if (state == 0)
+                NextStates[idx] = IsNextLive(rule, false, numNeighbours) ? 1 : 0;
+            else if (state == 1 && IsNextLive(rule, true, numNeighbours))
+                NextStates[idx] = 1;
+            else
+                NextStates[idx] = (uint8_t)((state + 1) % rule.numStates);
+        }
+    }
+}
+
+// Final states of the seed after the given generations, Back is scratch of the same size
+static void RunReference(const bool* Seed, uint8_t* States, uint8_t* Back, int numXCells, int numYCells, int generations)
+{
+    size_t numCells = (size_t)numXCells * numYCells;
+    for (size_t idx = 0; idx < numCells; idx++)
+        States[idx] = Seed[idx];
+    for (int gen = 0; gen < generations; gen++)
+    {
+        StepReference(States, Back, numXCells, numYCells, GetRule());
+        memcpy(States, Back, numCells);
+    }
+}
+
+// Runs the engine on the board of the reference, every state compared when it has them, state 1 otherwise
+static bool IsReferenceMatch(LifeEngineType type, const bool* Seed, const uint8_t* Reference, int numXCells, int numYCells,
+    int generations, ThreadPool* pool)
+{
+    size_t numCells = (size_t)numXCells * numYCells;
+    uint8_t* States = (uint8_t*)malloc(numCells);
+    LifeEngine engine;
+    if (States == NULL || InitEngine(&engine, type, numXCells, numYCells, pool) != true)
+    {
+        free(States);
+        return false;
+    }
+    LoadEngine(&engine, Seed);
+    for (int gen = 0; gen < generations; gen++)
+        StepEngine(&engine);
+
+    bool isMatch = true;
+    if (type == ENGINE_GENERATIONS)
+    {
+        StoreEngineStates(&engine, States);
+        isMatch = memcmp(Reference, States, numCells) == 0;
+    }
+    else
+    {
+        bool* Cells = (bool*)States;
+        StoreEngine(&engine, Cells);
+        for (size_t idx = 0; idx < numCells; idx++)
+            isMatch &= Cells[idx] == (Reference[idx] == 1);
+    }
+    FreeEngine(&engine);
+    free(States);
+
+    return isMatch;
+}
+
+/*
+Runs every byte grid kernel up to the one SelectCellKernel picked, the byte grid with temporal blocking
+of k = 1, 2, 4 and 8 generations, then every engine,
+from the same random board and reports cells/sec, memory and whether the final board
+matches the scalar byte grid reference, the unbounded engines included when the board holds the dead margin around the soup,
+and the multi-universe batch with the seed in all 64 lanes.
+Finally the engines are run with 1..maxThreads threads.
+Generations and range-R rules only run on their own engine, the byte grid has no states or range : the engine
+is checked against the naive per-cell reference on a board of at most BENCH_REFERENCE_CELLS squared.
+*/
+void RunBenchmark(int numXCells, int numYCells, int generations, int maxThreads)
+{
+    size_t numCells = (size_t)numXCells * numYCells;
+    bool* Seed = (bool*)malloc(numCells * sizeof(bool));
+    bool* Reference = (bool*)malloc(numCells * sizeof(bool));
+    bool* Result = (bool*)malloc(numCells * sizeof(bool));
+    if (Seed == NULL || Reference == NULL || Result == NULL)
+    {
+        printf("RunBenchmark malloc fail\n");
+        free(Seed);
+        free(Reference);
+        free(Result);
+        return;
+    }
+
+    SetCells(Seed, numXCells, numYCells, BENCH_SEED, SEED_DENSITY, NULL);
+
+    // Nothing travels faster than a cell per generation : inside a dead margin of generations cells the soup
+    // never reaches the clamped edges, and the byte grid is the window of the infinite plane of the unbounded engines
+    int margin = generations;
+    bool hasMargin = numXCells > 2 * margin && numYCells > 2 * margin;
+    for (int yidx = 0; hasMargin && yidx < numYCells; yidx++)
+    {
+        bool* row = Seed + (size_t)numXCells * yidx;
+        if (yidx < margin || yidx >= numYCells - margin)
+            memset(row, 0, numXCells * sizeof(bool));
+        memset(row, 0, margin * sizeof(bool));
+        memset(row + numXCells - margin, 0, margin * sizeof(bool));
+    }
+    printf("Benchmark %dx%d, %d generations\n", numXCells, numYCells, generations);
+
+    CellKernelType bestKernel = GetCellKernel();
+    bool hasReference = IsEngineSupported(ENGINE_BYTEGRID);
+
+    // Without the byte grid the naive reference runs once, on a board small enough for its per-cell loops
+    int refXCells = numXCells < BENCH_REFERENCE_CELLS ? numXCells : BENCH_REFERENCE_CELLS;
+    int refYCells = numYCells < BENCH_REFERENCE_CELLS ? numYCells : BENCH_REFERENCE_CELLS;
+    size_t numRefCells = (size_t)refXCells * refYCells;
+    bool* RefSeed = NULL;
+    uint8_t* RefStates = NULL;
+    uint8_t* RefBack = NULL;
+    if (hasReference != true)
+    {
+        RefSeed = (bool*)malloc(numRefCells * sizeof(bool));
+        RefStates = (uint8_t*)malloc(numRefCells);
+        RefBack = (uint8_t*)malloc(numRefCells);
+        if (RefSeed != NULL && RefStates != NULL && RefBack != NULL)
+        {
+            SetCells(RefSeed, refXCells, refYCells, BENCH_SEED, SEED_DENSITY, NULL);
+            RunReference(RefSeed, RefStates, RefBack, refXCells, refYCells, generations);
+            printf("Reference : naive per cell on %dx%d\n", refXCells, refYCells);
+        }
+        else
+        {
+            printf("RunBenchmark reference malloc fail\n");
+            free(RefStates);
+            RefStates = NULL;
+        }
+    }
+    double baseRate = 0.0;
+    for (int kernel = CELL_KERNEL_SCALAR; hasReference && kernel <= bestKernel; kernel++)
+    {
+        LifeEngine engine;
+        if (SetCellKernel((CellKernelType)kernel) != true)
+            continue;
+        if (InitEngine(&engine, ENGINE_BYTEGRID, numXCells, numYCells, NULL) != true)
+            break;
+        LoadEngine(&engine, Seed);
+
+        uint64_t allocs = 0;
+        double rate = (double)numCells * generations / TimeEngine(&engine, generations, &allocs);
+
+        StoreEngine(&engine, kernel == CELL_KERNEL_SCALAR ? Reference : Result);
+        bool isMatch = kernel == CELL_KERNEL_SCALAR || memcmp(Reference, Result, numCells * sizeof(bool)) == 0;
+        if (kernel == CELL_KERNEL_SCALAR)
+            baseRate = rate;
+
+        printf("  %-12s %-9s %10.1f Mcells/s  x%6.1f  %8.3f bytes/cell  %llu allocs  %s\n",
+            GetEngineName(ENGINE_BYTEGRID), GetCellKernelName((CellKernelType)kernel), rate / 1e6, rate / baseRate,
+            (double)GetEngineBytes(&engine) / numCells, (unsigned long long)allocs, isMatch ? "match" : "MISMATCH");
+
+        FreeEngine(&engine);
+    }
+    SetCellKernel(bestKernel);
+
+    // Temporal blocking with all threads, generations 2^k per pass, the rest of generations stepped one by one
+    ThreadPool blockPool;
+    if (hasReference && InitThreadPool(&blockPool, maxThreads))
+    {
+        printf("Temporal blocking (%d threads, %dx%d tiles)\n", maxThreads, CELL_TILE_X, CELL_TILE_Y);
+        double blockBaseRate = 0.0;
+        for (int stepLog2 = 0; stepLog2 <= CELL_MAX_STEP_LOG2; stepLog2++)
+        {
+            LifeEngine engine;
+            if (InitEngine(&engine, ENGINE_BYTEGRID, numXCells, numYCells, &blockPool) != true)
+                break;
+            SetEngineStep(&engine, stepLog2);
+            LoadEngine(&engine, Seed);
+
+            int numSteps = generations >> stepLog2;
+            uint64_t allocs = 0;
+            double rate = (double)numCells * ((uint64_t)numSteps << stepLog2) / TimeEngine(&engine, numSteps, &allocs);
+            AdvanceEngine(&engine, generations - ((uint64_t)numSteps << stepLog2));
+
+            StoreEngine(&engine, Result);
+            bool isMatch = memcmp(Reference, Result, numCells * sizeof(bool)) == 0;
+            if (stepLog2 == 0)
+                blockBaseRate = rate;
+
+            printf("  %-12s k = %-5d %10.1f Mcells/s  x%6.1f  %8.3f bytes/cell  %llu allocs  %s\n",
+                GetEngineName(ENGINE_BYTEGRID), 1 << stepLog2, rate / 1e6, rate / blockBaseRate,
+                (double)GetEngineBytes(&engine) / numCells, (unsigned long long)allocs, isMatch ? "match" : "MISMATCH");
+
+            FreeEngine(&engine);
+        }
+        FreeThreadPool(&blockPool);
+    }
+
+    for (int type = ENGINE_BYTEGRID + 1; type < NUM_ENGINES; type++)
+    {
+        LifeEngine engine;
+        if (IsEngineSupported((LifeEngineType)type) != true)
+            continue;
+        if (InitEngine(&engine, (LifeEngineType)type, numXCells, numYCells, NULL) != true)
+            continue;
+        LoadEngine(&engine, Seed);
+
+        uint64_t allocs = 0;
+        double rate = (double)numCells * generations / TimeEngine(&engine, generations, &allocs);
+
+        StoreEngine(&engine, Result);
+        bool isMatch = memcmp(Reference, Result, numCells * sizeof(bool)) == 0;
+        const char* check = IsEngineBounded((LifeEngineType)type) || hasMargin ?
+            (isMatch ? "match" : "MISMATCH") : "unbounded";
+        if (hasReference != true && RefStates != NULL)
+            check = IsReferenceMatch((LifeEngineType)type, RefSeed, RefStates, refXCells, refYCells, generations, NULL) ?
+                "match" : "MISMATCH";
+        else if (hasReference != true)
+            check = "unchecked";
+        if (baseRate == 0.0)
+            baseRate = rate;
+
+        printf("  %-22s %10.1f Mcells/s  x%6.1f  %8.3f bytes/cell  %llu allocs  %s\n",
+            GetEngineName((LifeEngineType)type), rate / 1e6, rate / baseRate,
+            (double)GetEngineBytes(&engine) / numCells, (unsigned long long)allocs, check);
+        if (type == ENGINE_BITBOARD)
+            printf("    active tiles : %d / %d\n", engine.bitBoard.numActiveTiles,
+                engine.bitBoard.numTilesX * engine.bitBoard.numTilesY);
+        if (type == ENGINE_BITBOARD && SetEngineStats(&engine, true))
+        {
+            // Same run with the stats fused into the tile kernel, the population checked against the board
+            LoadEngine(&engine, Seed);
+            double statsRate = (double)numCells * generations / TimeEngine(&engine, generations, &allocs);
+            LifeStats stats;
+            GetEngineStats(&engine, &stats);
+            uint64_t population = 0;
+            for (size_t idx = 0; idx < numCells; idx++)
+                population += Result[idx];
+            printf("    with stats : %10.1f Mcells/s  x%6.2f  population %llu  %s\n", statsRate / 1e6, statsRate / rate,
+                (unsigned long long)stats.population, stats.population == population ? "match" : "MISMATCH");
+        }
+        if (type == ENGINE_SPARSE)
+            printf("    population : %zu\n", engine.sparseLife.numLive);
+        if (type == ENGINE_CHUNKED)
+            printf("    chunks : %d, computed : %d, pooled : %d\n", engine.chunkLife.numChunks,
+                engine.chunkLife.numActiveChunks, engine.chunkLife.numBlocks * CHUNK_POOL_BLOCK);
+        if (type == ENGINE_INCREMENTAL)
+            printf("    changed cells : %d, evaluated : %d\n", engine.incrementalLife.numChanged,
+                engine.incrementalLife.numCandidates);
+
+        FreeEngine(&engine);
+    }
+
+    // Every lane runs the seed, the rate counts the cells of all 64 universes
+    MultiUniverse multi;
+    if (InitMultiUniverse(&multi, numXCells, numYCells))
+    {
+        for (int lane = 0; lane < MULTI_UNIVERSE_LANES; lane++)
+            LoadMultiUniverseLane(&multi, lane, Seed);
+
+        uint64_t allocStart = GetAllocCount();
+        auto start = std::chrono::steady_clock::now();
+        for (int gen = 0; gen < generations; gen++)
+            UpdateMultiUniverse(&multi, NULL);
+        auto stop = std::chrono::steady_clock::now();
+        uint64_t allocs = GetAllocCount() - allocStart;
+        double rate = (double)numCells * MULTI_UNIVERSE_LANES * generations / std::chrono::duration<double>(stop - start).count();
+
+        bool isMatch = true;
+        for (int lane = 0; lane < MULTI_UNIVERSE_LANES; lane++)
+        {
+            StoreMultiUniverseLane(&multi, lane, Result);
+            isMatch &= memcmp(Reference, Result, numCells * sizeof(bool)) == 0;
+        }
+        if (baseRate == 0.0)
+            baseRate = rate;
+
+        printf("  %-22s %10.1f Mcells/s  x%6.1f  %8.3f bytes/cell  %llu allocs  %s\n",
+            "Multi-Universe x64", rate / 1e6, rate / baseRate,
+            (double)multi.stride * (numYCells + 2) * sizeof(uint64_t) * 2 / ((double)numCells * MULTI_UNIVERSE_LANES),
+            (unsigned long long)allocs, hasReference ? (isMatch ? "match" : "MISMATCH") : "unchecked");
+        FreeMultiUniverse(&multi);
+    }
+
+    printf("Threads (gens/s)\n");
+    for (int numThreads = 1; numThreads <= maxThreads; numThreads++)
+    {
+        ThreadPool pool;
+        if (InitThreadPool(&pool, numThreads) != true)
+            break;
+
+        printf("  %3d", numThreads);
+        for (int type = 0; type < NUM_ENGINES; type++)
+        {
+            LifeEngine engine;
+            if (IsEngineSupported((LifeEngineType)type) != true)
+                continue;
+            if (InitEngine(&engine, (LifeEngineType)type, numXCells, numYCells, &pool) != true)
+                continue;
+            LoadEngine(&engine, Seed);
+
+            uint64_t allocs = 0;
+            double gensPerSecond = generations / TimeEngine(&engine, generations, &allocs);
+
+            StoreEngine(&engine, Result);
+            bool isMatch = memcmp(Reference, Result, numCells * sizeof(bool)) == 0;
+            const char* check = IsEngineBounded((LifeEngineType)type) || hasMargin ?
+                (isMatch ? "match" : "MISMATCH") : "unbounded";
+            if (hasReference != true && RefStates != NULL)
+                check = IsReferenceMatch((LifeEngineType)type, RefSeed, RefStates, refXCells, refYCells, generations, &pool) ?
+                    "match" : "MISMATCH";
+            else if (hasReference != true)
+                check = "unchecked";
+            printf("  %s %10.1f %s", GetEngineName((LifeEngineType)type), gensPerSecond, check);
+
+            FreeEngine(&engine);
+        }
+        printf("\n");
+        if (numThreads == maxThreads)
+            PrintThreadPoolStats(&pool);
+
+        FreeThreadPool(&pool);
+    }
+
+    free(Seed);
+    free(Reference);
+    free(Result);
+    free(RefSeed);
+    free(RefStates);
+    free(RefBack);
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+#define BENCH_X_CELLS 4096
+#define BENCH_Y_CELLS 4096
+#define BENCH_GENERATIONS 50
+#define BENCH_SEED 1            // every run starts from the same board
+#define BENCH_REFERENCE_CELLS 256   // largest side of the board checked against the naive reference
+
+void RunBenchmark(int numXCells, int numYCells, int generations, int maxThreads);
@@ -0,0 +1,731 @@
+#include "BitBoard.h"
+#include "BitSlice.h"
+#include "Memory.h"
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+
+// x86 builds without -mpopcnt count the stats with the SWAR PopCount, unless the CPU runs the POPCNT kernel
+#if (defined(__x86_64__) || defined(__i386__)) && !defined(__POPCNT__) && !(defined(_MSC_VER) && !defined(__clang__))
+#define BIT_BOARD_POPCNT 1
+#else
+#define BIT_BOARD_POPCNT 0
+#endif
+
+bool InitBitBoard(BitBoard* board, int numXCells, int numYCells)
+{
+    memset(board, 0, sizeof(BitBoard));
+    board->numXCells = numXCells;
+    board->numYCells = numYCells;
+    board->numWords = (numXCells + 63) / 64;
+    board->isReserved = board->numWords >= REGION_WORDS;
+    board->stride = board->isReserved ? (board->numWords + REGION_WORDS - 1) & ~(REGION_WORDS - 1) : (board->numWords + 7) & ~7;
+    board->lastMask = (numXCells % 64 == 0) ? ~0ULL : ((1ULL << (numXCells % 64)) - 1);
+    board->numTilesX = (board->numWords + TILE_WORDS - 1) / TILE_WORDS;
+    board->numTilesY = (numYCells + TILE_ROWS - 1) / TILE_ROWS;
+    board->numRegionsX = board->stride / REGION_WORDS;
+
+    size_t size = (size_t)board->stride * numYCells * sizeof(uint64_t);
+    int numTiles = board->numTilesX * board->numTilesY;
+    int numRegions = board->isReserved ? board->numRegionsX * board->numTilesY : 0;
+    if (board->isReserved)
+    {
+        board->Front = (uint64_t*)ReserveLifeMemory(size);
+        board->Back = (uint64_t*)ReserveLifeMemory(size);
+        board->IsCommitted = (bool*)LifeAlloc(numRegions * sizeof(bool));
+        board->LastUsed = (uint32_t*)LifeAlloc(numRegions * sizeof(uint32_t));
+    }
+    else
+    {
+        board->Front = (uint64_t*)LifeAlloc(size);
+        board->Back = (uint64_t*)LifeAlloc(size);
+    }
+    board->Changed = (uint8_t*)LifeAlloc(numTiles);
+    board->NextChanged = (uint8_t*)LifeAlloc(numTiles);
+    board->RowChanged = (uint8_t*)LifeAlloc(board->numTilesY);
+    board->NextRowChanged = (uint8_t*)LifeAlloc(board->numTilesY);
+    board->ActiveTiles = (int*)LifeAlloc(numTiles * sizeof(int));
+    board->Stats = (BitTileStats*)LifeAlloc(numTiles * sizeof(BitTileStats));
+    board->BackStats = (BitTileStats*)LifeAlloc(numTiles * sizeof(BitTileStats));
+    if (board->Front == NULL || board->Back == NULL || board->Changed == NULL || board->NextChanged == NULL ||
+        board->RowChanged == NULL || board->NextRowChanged == NULL || board->ActiveTiles == NULL || board->Stats == NULL || board->BackStats == NULL ||
+        (board->isReserved && (board->IsCommitted == NULL || board->LastUsed == NULL)))
+    {
+        printf("BitBoard LifeAlloc fail\n");
+        FreeBitBoard(board);
+        return false;
+    }
+    // Reserved pages are zero already, the stats are counted by SetBitBoardStats before they are read
+    if (board->isReserved)
+    {
+        memset(board->IsCommitted, 0, numRegions * sizeof(bool));
+        memset(board->LastUsed, 0, numRegions * sizeof(uint32_t));
+    }
+    else
+    {
+        memset(board->Front, 0, size);
+        memset(board->Back, 0, size);
+    }
+    // NextChanged is not cleared yet
+    memset(board->NextRowChanged, 1, board->numTilesY);
+    MarkBitBoardChanged(board);
+
+    return true;
+}
+
+void FreeBitBoard(BitBoard* board)
+{
+    if (board->isReserved)
+    {
+        size_t size = (size_t)board->stride * board->numYCells * sizeof(uint64_t);
+        FreeLifeMemory(board->Front, size);
+        FreeLifeMemory(board->Back, size);
+    }
+    else
+    {
+        LifeFree(board->Front);
+        LifeFree(board->Back);
+    }
+    LifeFree(board->Changed);
+    LifeFree(board->NextChanged);
+    LifeFree(board->RowChanged);
+    LifeFree(board->NextRowChanged);
+    LifeFree(board->ActiveTiles);
+    LifeFree(board->Stats);
+    LifeFree(board->BackStats);
+    LifeFree(board->IsCommitted);
+    LifeFree(board->LastUsed);
+    board->Stats = NULL;
+    board->BackStats = NULL;
+    board->Front = NULL;
+    board->Back = NULL;
+    board->Changed = NULL;
+    board->NextChanged = NULL;
+    board->RowChanged = NULL;
+    board->NextRowChanged = NULL;
+    board->ActiveTiles = NULL;
+    board->IsCommitted = NULL;
+    board->LastUsed = NULL;
+}
+
+static inline int GetRegion(const BitBoard* board, int tx, int ty)
+{
+    return tx / (REGION_WORDS / TILE_WORDS) + board->numRegionsX * ty;
+}
+
+// Regions of boards that are not reserved are always there
+static inline bool IsTileCommitted(const BitBoard* board, int tileIdx)
+{
+    return board->isReserved != true ||
+        board->IsCommitted[GetRegion(board, tileIdx % board->numTilesX, tileIdx / board->numTilesX)];
+}
+
+// Rows of the region, its page of every row starts offset words into the row
+static void GetRegionPages(const BitBoard* board, int regionIdx, int* yBegin, int* yEnd, size_t* offset)
+{
+    *yBegin = (regionIdx / board->numRegionsX) * TILE_ROWS;
+    *yEnd = *yBegin + TILE_ROWS < board->numYCells ? *yBegin + TILE_ROWS : board->numYCells;
+    *offset = (size_t)(regionIdx % board->numRegionsX) * REGION_WORDS;
+}
+
+static bool CommitRegion(BitBoard* board, int regionIdx)
+{
+    board->LastUsed[regionIdx] = board->numUpdates;
+    if (board->IsCommitted[regionIdx])
+        return true;
+
+    int yBegin, yEnd;
+    size_t offset;
+    GetRegionPages(board, regionIdx, &yBegin, &yEnd, &offset);
+    for (int yidx = yBegin; yidx < yEnd; yidx++)
+    {
+        if (CommitLifeMemory(board->Front + (size_t)board->stride * yidx + offset, REGION_WORDS * sizeof(uint64_t)) != true ||
+            CommitLifeMemory(board->Back + (size_t)board->stride * yidx + offset, REGION_WORDS * sizeof(uint64_t)) != true)
+        {
+            printf("BitBoard CommitLifeMemory fail\n");
+            return false;
+        }
+    }
+    board->IsCommitted[regionIdx] = true;
+    board->numCommitted++;
+    board->maxCommitted = board->numCommitted > board->maxCommitted ? board->numCommitted : board->maxCommitted;
+    return true;
+}
+
+// Regions no active tile came near for REGION_IDLE updates go back to the OS once they are dead in Front and Back
+static void ReleaseDeadRegions(BitBoard* board)
+{
+    for (int regionIdx = 0; regionIdx < board->numRegionsX * board->numTilesY; regionIdx++)
+    {
+        if (board->IsCommitted[regionIdx] != true || board->numUpdates - board->LastUsed[regionIdx] < REGION_IDLE)
+            continue;
+
+        int yBegin, yEnd;
+        size_t offset;
+        GetRegionPages(board, regionIdx, &yBegin, &yEnd, &offset);
+        uint64_t live = 0;
+        for (int yidx = yBegin; yidx < yEnd; yidx++)
+        {
+            const uint64_t* front = board->Front + (size_t)board->stride * yidx + offset;
+            const uint64_t* back = board->Back + (size_t)board->stride * yidx + offset;
+            for (int widx = 0; widx < REGION_WORDS; widx++)
+                live |= front[widx] | back[widx];
+        }
+        if (live != 0)
+            continue;
+
+        for (int yidx = yBegin; yidx < yEnd; yidx++)
+        {
+            DecommitLifeMemory(board->Front + (size_t)board->stride * yidx + offset, REGION_WORDS * sizeof(uint64_t));
+            DecommitLifeMemory(board->Back + (size_t)board->stride * yidx + offset, REGION_WORDS * sizeof(uint64_t));
+        }
+        board->IsCommitted[regionIdx] = false;
+        board->numCommitted--;
+    }
+}
+
+// Commits the regions of the 3x3 tiles around tile (tx, ty), which its update reads
+static bool CommitTileRegions(BitBoard* board, int tx, int ty)
+{
+    int tym = ty > 0 ? ty - 1 : 0;
+    int typ = ty < board->numTilesY - 1 ? ty + 1 : ty;
+    int txm = tx > 0 ? tx - 1 : 0;
+    int txp = tx < board->numTilesX - 1 ? tx + 1 : tx;
+    for (int ny = tym; ny <= typ; ny++)
+    {
+        if (CommitRegion(board, GetRegion(board, txm, ny)) != true || CommitRegion(board, GetRegion(board, txp, ny)) != true)
+            return false;
+    }
+    return true;
+}
+
+/*
+Updates words [wBegin, wEnd) of one row.
+Returns CHANGED_1 when the row differs from the current generation (mid) and CHANGED_2 when it differs
+from generation t-1, which out still holds before it is overwritten.
+Window Boundary Rule : same clamping as CheckRule, the cell beyond the edge is the edge cell itself.
+First word : the virtual word before it carries bit 0 into the West shift.
+Last word : the East shift of the last valid bit is replaced by that bit.
+HasStats : births and deaths of the row are added to stats from the words in registers,
+HasPopcnt counts them with PopCountNative, inlined into a kernel compiled for POPCNT.
+*/
+template <int Birth, int Survival, bool HasStats, bool HasPopcnt>
+static int UpdateRow(const uint64_t* up, const uint64_t* mid, const uint64_t* down, uint64_t* out,
+                     int wBegin, int wEnd, int numWords, uint64_t lastMask, Rule rule, BitTileStats* stats)
+{
+    uint64_t diff1 = 0, diff2 = 0;
+    int births = 0, deaths = 0;
+    uint64_t u = up[wBegin], m = mid[wBegin], d = down[wBegin];
+    uint64_t up_ = wBegin > 0 ? up[wBegin - 1] : u << 63;
+    uint64_t mp = wBegin > 0 ? mid[wBegin - 1] : m << 63;
+    uint64_t dp = wBegin > 0 ? down[wBegin - 1] : d << 63;
+    int wLast = wEnd < numWords ? wEnd : numWords - 1;
+
+    for (int widx = wBegin; widx < wLast; widx++)
+    {
+        uint64_t un = up[widx + 1], mn = mid[widx + 1], dn = down[widx + 1];
+
+        uint64_t next = LifeWord<Birth, Survival>(West(u, up_), u, East(u, un),
+                                                  West(m, mp), m, East(m, mn),
+                                                  West(d, dp), d, East(d, dn), rule);
+        diff1 |= next ^ m;
+        diff2 |= next ^ out[widx];
+        out[widx] = next;
+        if (HasStats)
+        {
+            births += HasPopcnt ? PopCountNative(next & ~m) : PopCount(next & ~m);
+            deaths += HasPopcnt ? PopCountNative(m & ~next) : PopCount(m & ~next);
+        }
+
+        up_ = u; mp = m; dp = d;
+        u = un; m = mn; d = dn;
+    }
+    if (wEnd == numWords)
+    {
+        uint64_t edge = lastMask & ~(lastMask >> 1);
+        uint64_t next = LifeWord<Birth, Survival>(West(u, up_), u, (u >> 1) | (u & edge),
+                                                  West(m, mp), m, (m >> 1) | (m & edge),
+                                                  West(d, dp), d, (d >> 1) | (d & edge), rule) & lastMask;
+        diff1 |= next ^ m;
+        diff2 |= next ^ out[numWords - 1];
+        out[numWords - 1] = next;
+        if (HasStats)
+        {
+            births += HasPopcnt ? PopCountNative(next & ~m) : PopCount(next & ~m);
+            deaths += HasPopcnt ? PopCountNative(m & ~next) : PopCount(m & ~next);
+        }
+    }
+
+    if (HasStats)
+    {
+        stats->births += births;
+        stats->deaths += deaths;
+    }
+
+    return (diff1 != 0 ? CHANGED_1 : 0) | (diff2 != 0 ? CHANGED_2 : 0);
+}
+
+static void ClearTileStats(BitTileStats* stats)
+{
+    stats->population = 0;
+    stats->births = 0;
+    stats->deaths = 0;
+    stats->xMin = INT_MAX;
+    stats->yMin = INT_MAX;
+    stats->xMax = INT_MIN;
+    stats->yMax = INT_MIN;
+}
+
+// Widens the bounding box by the live cells of words [wBegin, wEnd) of row yidx
+static void AddRowBox(const uint64_t* row, int wBegin, int wEnd, int yidx, BitTileStats* stats)
+{
+    int wFirst = wBegin;
+    while (wFirst < wEnd && row[wFirst] == 0)
+        wFirst++;
+    if (wFirst == wEnd)
+        return;
+    int wLast = wEnd - 1;
+    while (row[wLast] == 0)
+        wLast--;
+
+    int xMin = wFirst * 64 + LowestBit(row[wFirst]);
+    int xMax = wLast * 64 + HighestBit(row[wLast]);
+    stats->xMin = xMin < stats->xMin ? xMin : stats->xMin;
+    stats->xMax = xMax > stats->xMax ? xMax : stats->xMax;
+    stats->yMin = yidx < stats->yMin ? yidx : stats->yMin;
+    stats->yMax = yidx > stats->yMax ? yidx : stats->yMax;
+}
+
+template <int Birth, int Survival, bool HasStats, bool HasPopcnt>
+static int UpdateTile(const BitBoard* board, int tileIdx)
+{
+    Rule rule = GetRule();
+    int changed = 0;
+    int stride = board->stride;
+    int lastRow = board->numYCells - 1;
+    int yBegin = (tileIdx / board->numTilesX) * TILE_ROWS;
+    int yEnd = yBegin + TILE_ROWS < board->numYCells ? yBegin + TILE_ROWS : board->numYCells;
+    int wBegin = (tileIdx % board->numTilesX) * TILE_WORDS;
+    int wEnd = wBegin + TILE_WORDS < board->numWords ? wBegin + TILE_WORDS : board->numWords;
+
+    BitTileStats stats;
+    if (HasStats)
+        ClearTileStats(&stats);
+
+    for (int yidx = yBegin; yidx < yEnd; yidx++)
+    {
+        int ym = yidx > 0 ? yidx - 1 : 0;
+        int yp = yidx < lastRow ? yidx + 1 : lastRow;
+        uint64_t* out = board->Back + (size_t)stride * yidx;
+
+        changed |= UpdateRow<Birth, Survival, HasStats, HasPopcnt>(board->Front + (size_t)stride * ym,
+                                                                   board->Front + (size_t)stride * yidx,
+                                                                   board->Front + (size_t)stride * yp,
+                                                                   out, wBegin, wEnd, board->numWords, board->lastMask, rule, &stats);
+        if (HasStats)
+            AddRowBox(out, wBegin, wEnd, yidx, &stats);
+    }
+
+    // The population follows from the one of the current generation
+    if (HasStats)
+    {
+        stats.population = board->Stats[tileIdx].population + stats.births - stats.deaths;
+        board->BackStats[tileIdx] = stats;
+    }
+
+    return changed;
+}
+
+#if BIT_BOARD_POPCNT
+// flatten inlines the rows into the kernel, so their popcounts compile to POPCNT
+template <int Birth, int Survival>
+__attribute__((target("popcnt"), flatten)) static int UpdateTilePopcnt(const BitBoard* board, int tileIdx)
+{
+    return UpdateTile<Birth, Survival, true, true>(board, tileIdx);
+}
+#else
+template <int Birth, int Survival>
+static int UpdateTilePopcnt(const BitBoard* board, int tileIdx)
+{
+    return UpdateTile<Birth, Survival, true, false>(board, tileIdx);
+}
+#endif
+
+typedef int (*TileKernel)(const BitBoard* board, int tileIdx);
+
+#define TILE_KERNEL_PLAIN 0
+#define TILE_KERNEL_STATS 1
+#define TILE_KERNEL_STATS_POPCNT 2
+
+static const TileKernel TileKernels[3][NUM_RULE_KERNELS] =
+{
+    {
+        UpdateTile<RULE_RUNTIME, RULE_RUNTIME, false, false>,
+        UpdateTile<RULE_B3, RULE_S23, false, false>,
+        UpdateTile<RULE_B36, RULE_S23, false, false>,
+        UpdateTile<RULE_B3678, RULE_S34678, false, false>,
+    },
+    {
+        UpdateTile<RULE_RUNTIME, RULE_RUNTIME, true, false>,
+        UpdateTile<RULE_B3, RULE_S23, true, false>,
+        UpdateTile<RULE_B36, RULE_S23, true, false>,
+        UpdateTile<RULE_B3678, RULE_S34678, true, false>,
+    },
+    {
+        UpdateTilePopcnt<RULE_RUNTIME, RULE_RUNTIME>,
+        UpdateTilePopcnt<RULE_B3, RULE_S23>,
+        UpdateTilePopcnt<RULE_B36, RULE_S23>,
+        UpdateTilePopcnt<RULE_B3678, RULE_S34678>,
+    },
+};
+
+// Stats kernel of this CPU, checked once at startup like the cell kernels
+static int DetectStatsKernel()
+{
+#if BIT_BOARD_POPCNT
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("popcnt"))
+        return TILE_KERNEL_STATS_POPCNT;
+#endif
+    return TILE_KERNEL_STATS;
+}
+
+static const int StatsKernel = DetectStatsKernel();
+
+// Returns the CHANGED_1 / CHANGED_2 flags of the new generation of the tile
+int UpdateBitBoardTile(const BitBoard* board, int tileIdx)
+{
+    return TileKernels[board->hasStats ? StatsKernel : TILE_KERNEL_PLAIN][GetRuleKernel()](board, tileIdx);
+}
+
+void SwapBitBoard(BitBoard* board)
+{
+    uint64_t* tmp = board->Front;
+    board->Front = board->Back;
+    board->Back = tmp;
+
+    BitTileStats* tmpStats = board->Stats;
+    board->Stats = board->BackStats;
+    board->BackStats = tmpStats;
+}
+
+// Stats of the tile in Front counted from scratch, after edits and loads, without births and deaths
+static void CountTileStats(BitBoard* board, int tileIdx)
+{
+    BitTileStats* stats = &board->Stats[tileIdx];
+    int yBegin = (tileIdx / board->numTilesX) * TILE_ROWS;
+    int yEnd = yBegin + TILE_ROWS < board->numYCells ? yBegin + TILE_ROWS : board->numYCells;
+    int wBegin = (tileIdx % board->numTilesX) * TILE_WORDS;
+    int wEnd = wBegin + TILE_WORDS < board->numWords ? wBegin + TILE_WORDS : board->numWords;
+
+    ClearTileStats(stats);
+    if (IsTileCommitted(board, tileIdx) != true)
+    {
+        // Back is dead too, the tile is skipped until a neighbour changes
+        board->BackStats[tileIdx] = *stats;
+        return;
+    }
+    for (int yidx = yBegin; yidx < yEnd; yidx++)
+    {
+        const uint64_t* row = board->Front + (size_t)board->stride * yidx;
+        uint32_t population = stats->population;
+        for (int widx = wBegin; widx < wEnd; widx++)
+            stats->population += PopCount(row[widx]);
+        if (stats->population != population)
+            AddRowBox(row, wBegin, wEnd, yidx, stats);
+    }
+}
+
+/*
+Turning stats on counts the current generation and computes every tile twice like an edit,
+so BackStats holds generation t-1 before any tile is skipped again.
+*/
+void SetBitBoardStats(BitBoard* board, bool hasStats)
+{
+    if (hasStats && board->hasStats != true)
+    {
+        for (int tileIdx = 0; tileIdx < board->numTilesX * board->numTilesY; tileIdx++)
+            CountTileStats(board, tileIdx);
+        MarkBitBoardChanged(board);
+    }
+    board->hasStats = hasStats;
+}
+
+// Sum of the tiles of the generation in Front, stats->generation is left to the caller
+void GetBitBoardStats(const BitBoard* board, LifeStats* stats)
+{
+    stats->population = 0;
+    stats->births = 0;
+    stats->deaths = 0;
+    stats->xMin = INT_MAX;
+    stats->yMin = INT_MAX;
+    stats->xMax = INT_MIN;
+    stats->yMax = INT_MIN;
+    for (int tileIdx = 0; tileIdx < board->numTilesX * board->numTilesY; tileIdx++)
+    {
+        const BitTileStats* tile = &board->Stats[tileIdx];
+        stats->population += tile->population;
+        stats->births += tile->births;
+        stats->deaths += tile->deaths;
+        stats->xMin = tile->xMin < stats->xMin ? tile->xMin : stats->xMin;
+        stats->yMin = tile->yMin < stats->yMin ? tile->yMin : stats->yMin;
+        stats->xMax = tile->xMax > stats->xMax ? tile->xMax : stats->xMax;
+        stats->yMax = tile->yMax > stats->yMax ? tile->yMax : stats->yMax;
+    }
+}
+
+static void UpdateBitBoardTileTask(void* context, int taskIdx, int threadIdx)
+{
+    const BitBoard* board = (const BitBoard*)context;
+    int tileIdx = board->ActiveTiles[taskIdx];
+
+    int changed = UpdateBitBoardTile(board, tileIdx);
+    if (board->Changed[tileIdx] & CHANGED_EDIT)
+        changed |= CHANGED_2;
+    board->NextChanged[tileIdx] = (uint8_t)changed;
+}
+
+static bool IsTileRowChanged(const BitBoard* board, const uint8_t* Changed, int ty)
+{
+    const uint8_t* row = Changed + (size_t)board->numTilesX * ty;
+    uint8_t changed = 0;
+    for (int tx = 0; tx < board->numTilesX; tx++)
+        changed |= row[tx];
+    return changed != 0;
+}
+
+/*
+Collects the tiles that have to be computed : some tile of the 3x3 neighbourhood changed since t-1
+and some (maybe other) tile changed since t-2. A skipped tile keeps Back, which is generation t+1,
+so it still differs from t exactly where it differed from t-1, and no longer differs from t-1.
+Rows of tiles with no change in the 3 rows around them are skipped whole, without touching their
+Changed bytes or stats : unchanged since t-1 and t-2, both stats buffers of their tiles already hold
+no births and deaths. Giant boards commit the regions around every active tile.
+Returns -1 when a region cannot be committed.
+*/
+static int CollectActiveTiles(BitBoard* board)
+{
+    int numTilesX = board->numTilesX;
+    int numTilesY = board->numTilesY;
+    int numActive = 0;
+
+    for (int ty = 0; ty < numTilesY; ty++)
+    {
+        int tym = ty > 0 ? ty - 1 : 0;
+        int typ = ty < numTilesY - 1 ? ty + 1 : ty;
+        if ((board->RowChanged[tym] | board->RowChanged[ty] | board->RowChanged[typ]) == 0)
+        {
+            if (board->NextRowChanged[ty])
+                memset(board->NextChanged + (size_t)numTilesX * ty, 0, numTilesX);
+            board->NextRowChanged[ty] = 0;
+            continue;
+        }
+        board->NextRowChanged[ty] = 1;  // counted once the row is updated
+
+        for (int tx = 0; tx < numTilesX; tx++)
+        {
+            int txm = tx > 0 ? tx - 1 : 0;
+            int txp = tx < numTilesX - 1 ? tx + 1 : tx;
+            int changed = 0;
+            for (int ny = tym; ny <= typ; ny++)
+            {
+                for (int nx = txm; nx <= txp; nx++)
+                {
+                    changed |= board->Changed[nx + numTilesX * ny];
+                }
+            }
+
+            int tileIdx = tx + numTilesX * ty;
+            if ((changed & (CHANGED_1 | CHANGED_2)) == (CHANGED_1 | CHANGED_2))
+            {
+                if (board->isReserved && CommitTileRegions(board, tx, ty) != true)
+                    return -1;
+                board->ActiveTiles[numActive++] = tileIdx;
+            }
+            else
+            {
+                board->NextChanged[tileIdx] = board->Changed[tileIdx] & CHANGED_1;
+                if (board->hasStats)
+                {
+                    board->BackStats[tileIdx].births = board->Stats[tileIdx].deaths;
+                    board->BackStats[tileIdx].deaths = board->Stats[tileIdx].births;
+                }
+            }
+        }
+    }
+
+    return numActive;
+}
+
+// Tiles of regions that are not committed are dead and need no update until a neighbour changes
+void MarkBitBoardChanged(BitBoard* board)
+{
+    memset(board->Changed, CHANGED_1 | CHANGED_2 | CHANGED_EDIT, board->numTilesX * board->numTilesY);
+    for (int tileIdx = 0; board->isReserved && tileIdx < board->numTilesX * board->numTilesY; tileIdx++)
+    {
+        if (IsTileCommitted(board, tileIdx) != true)
+            board->Changed[tileIdx] = 0;
+    }
+    for (int ty = 0; ty < board->numTilesY; ty++)
+        board->RowChanged[ty] = IsTileRowChanged(board, board->Changed, ty);
+}
+
+bool UpdateBitBoard(BitBoard* board, ThreadPool* pool)
+{
+    if (board->Front == NULL || board->Back == NULL)
+    {
+        printf("UpdateBitBoard fail\n");
+        return false;
+    }
+
+    int numActive = CollectActiveTiles(board);
+    if (numActive < 0)
+    {
+        printf("UpdateBitBoard fail\n");
+        return false;
+    }
+    board->numActiveTiles = numActive;
+    if (pool != NULL && pool->numThreads > 1)
+    {
+        RunThreadPoolStealing(pool, UpdateBitBoardTileTask, board, board->numActiveTiles);
+    }
+    else
+    {
+        for (int taskIdx = 0; taskIdx < board->numActiveTiles; taskIdx++)
+        {
+            UpdateBitBoardTileTask(board, taskIdx, 0);
+        }
+    }
+    SwapBitBoard(board);
+
+    for (int ty = 0; ty < board->numTilesY; ty++)
+    {
+        if (board->NextRowChanged[ty])
+            board->NextRowChanged[ty] = IsTileRowChanged(board, board->NextChanged, ty);
+    }
+    uint8_t* tmpChanged = board->Changed;
+    board->Changed = board->NextChanged;
+    board->NextChanged = tmpChanged;
+    tmpChanged = board->RowChanged;
+    board->RowChanged = board->NextRowChanged;
+    board->NextRowChanged = tmpChanged;
+
+    board->numUpdates++;
+    if (board->isReserved && board->numUpdates % REGION_IDLE == 0)
+        ReleaseDeadRegions(board);
+
+    return true;
+}
+
+// Live cells of the generation in Front, regions that are not committed are dead
+uint64_t GetBitBoardPopulation(const BitBoard* board)
+{
+    uint64_t population = 0;
+    for (int yidx = 0; yidx < board->numYCells; yidx++)
+    {
+        const uint64_t* row = board->Front + (size_t)board->stride * yidx;
+        for (int widx = 0; widx < board->numWords; widx++)
+        {
+            if (board->isReserved && widx % REGION_WORDS == 0 &&
+                board->IsCommitted[widx / REGION_WORDS + board->numRegionsX * (yidx / TILE_ROWS)] != true)
+            {
+                widx += REGION_WORDS - 1;
+                continue;
+            }
+            population += PopCount(row[widx]);
+        }
+    }
+    return population;
+}
+
+// Memory of Front and Back, committed now or at most at once
+size_t GetBitBoardCommittedBytes(const BitBoard* board, bool isPeak)
+{
+    if (board->isReserved != true)
+        return (size_t)board->stride * board->numYCells * sizeof(uint64_t) * 2;
+    int numRegions = isPeak ? board->maxCommitted : board->numCommitted;
+    return (size_t)numRegions * TILE_ROWS * REGION_WORDS * sizeof(uint64_t) * 2;
+}
+
+bool GetBitBoardCell(const BitBoard* board, int xidx, int yidx)
+{
+    if (IsTileCommitted(board, (xidx >> 6) / TILE_WORDS + board->numTilesX * (yidx / TILE_ROWS)) != true)
+        return false;
+    uint64_t word = board->Front[(size_t)board->stride * yidx + (xidx >> 6)];
+    return (word >> (xidx & 63)) & 1;
+}
+
+void SetBitBoardCell(BitBoard* board, int xidx, int yidx, bool live)
+{
+    if (board->isReserved && CommitRegion(board, GetRegion(board, (xidx >> 6) / TILE_WORDS, yidx / TILE_ROWS)) != true)
+        return;
+    uint64_t* word = &board->Front[(size_t)board->stride * yidx + (xidx >> 6)];
+    uint64_t bit = 1ULL << (xidx & 63);
+    if (live)
+        *word |= bit;
+    else
+        *word &= ~bit;
+    int tileIdx = (xidx >> 6) / TILE_WORDS + board->numTilesX * (yidx / TILE_ROWS);
+    board->Changed[tileIdx] = CHANGED_1 | CHANGED_2 | CHANGED_EDIT;
+    board->RowChanged[yidx / TILE_ROWS] = 1;
+    if (board->hasStats)
+        CountTileStats(board, tileIdx);
+}
+
+// Giant boards only commit the regions with live cells
+void LoadBitBoard(BitBoard* board, const bool* Cells)
+{
+    int numXCells = board->numXCells;
+    int segmentCells = board->isReserved ? REGION_WORDS * 64 : board->stride * 64;
+
+    for (int yidx = 0; yidx < board->numYCells; yidx++)
+    {
+        uint64_t* row = board->Front + (size_t)board->stride * yidx;
+        const bool* src = Cells + (size_t)numXCells * yidx;
+
+        for (int xBegin = 0; xBegin < numXCells; xBegin += segmentCells)
+        {
+            int xEnd = xBegin + segmentCells < numXCells ? xBegin + segmentCells : numXCells;
+            if (board->isReserved)
+            {
+                int regionIdx = GetRegion(board, (xBegin >> 6) / TILE_WORDS, yidx / TILE_ROWS);
+                bool isLive = memchr(src + xBegin, true, xEnd - xBegin) != NULL;
+                if (board->IsCommitted[regionIdx] != true && (isLive != true || CommitRegion(board, regionIdx) != true))
+                    continue;
+            }
+
+            memset(row + (xBegin >> 6), 0, (segmentCells >> 6) * sizeof(uint64_t));
+            for (int xidx = xBegin; xidx < xEnd; xidx++)
+            {
+                row[xidx >> 6] |= (uint64_t)src[xidx] << (xidx & 63);
+            }
+        }
+    }
+    MarkBitBoardChanged(board);
+    for (int tileIdx = 0; board->hasStats && tileIdx < board->numTilesX * board->numTilesY; tileIdx++)
+        CountTileStats(board, tileIdx);
+}
+
+void StoreBitBoard(const BitBoard* board, bool* Cells)
+{
+    int numXCells = board->numXCells;
+
+    for (int yidx = 0; yidx < board->numYCells; yidx++)
+    {
+        const uint64_t* row = board->Front + (size_t)board->stride * yidx;
+        bool* dst = Cells + (size_t)numXCells * yidx;
+
+        for (int xidx = 0; xidx < numXCells; xidx++)
+        {
+            if (board->isReserved && xidx % (REGION_WORDS * 64) == 0 &&
+                board->IsCommitted[GetRegion(board, (xidx >> 6) / TILE_WORDS, yidx / TILE_ROWS)] != true)
+            {
+                int xEnd = xidx + REGION_WORDS * 64 < numXCells ? xidx + REGION_WORDS * 64 : numXCells;
+                memset(dst + xidx, 0, xEnd - xidx);
+                xidx = xEnd - 1;
+                continue;
+            }
+            dst[xidx] = (row[xidx >> 6] >> (xidx & 63)) & 1;
+        }
+    }
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <stdint.h>
+#include "ThreadPool.h"
+#include "LifeStats.h"
+
+#define TILE_ROWS 32
+#define TILE_WORDS 8
+
+#define REGION_WORDS 512    // giant boards : a region is TILE_ROWS rows of REGION_WORDS words, one page per row
+#define REGION_IDLE 64      // updates without an active tile near a region before its dead pages are released
+
+#define CHANGED_1 1
+#define CHANGED_2 2
+#define CHANGED_EDIT 4
+
+/*
+Bit-packed board : 64 cells per uint64_t word, bit (x % 64) of word (x / 64) is cell x of the row.
+Rows are padded to a whole cache line (8 words) so that tiles never share a line.
+Front holds the current generation, Back receives the next one and the two are swapped by pointer.
+The board is updated in tiles of TILE_ROWS x TILE_WORDS words (32 x 512 cells), scheduled by
+work stealing when a thread pool is given.
+Activity tracking (as in QuickLife) : every tile remembers whether it changed since 1 and 2 generations ago.
+If its 3x3 tile neighbourhood is unchanged since 1 generation ago (still life) or 2 generations ago
+(period 2, e.g. blinkers), the next generation equals generation t-1, which Back already holds,
+so the tile is skipped without reading or writing it.
+An edited tile no longer follows from generation t-1, CHANGED_EDIT keeps it out of the period 2 skip
+until it has been computed twice.
+Giant boards, at least REGION_WORDS words wide : Front and Back are reserved address space with
+rows padded to whole pages, so Front[stride * y + x / 64] stays flat indexing. A region is committed
+when a tile next to it becomes active or a cell in it is set, so untouched space never faults in, and
+every REGION_IDLE updates the regions no active tile came near are checked, those dead in Front and
+Back are decommitted. Resident memory follows the live area, reads of a region that is not committed
+see dead cells.
+With hasStats the tile kernel also counts births and deaths with popcounts of the words it computes,
+the population follows from them, and the live bounding box of the tile. x86 builds without -mpopcnt
+pick a stats kernel compiled for POPCNT at startup when the CPU has it. A skipped tile repeats
+generation t-1, so its stats are those of t-1 with births and deaths of t swapped.
+*/
+struct BitTileStats
+{
+    uint32_t population;
+    uint32_t births;
+    uint32_t deaths;
+    int xMin, yMin, xMax, yMax;     // empty tile : xMin > xMax
+};
+
+struct BitBoard
+{
+    int numXCells;
+    int numYCells;
+    int numWords;       // used words per row
+    int stride;         // words per row including padding
+    uint64_t lastMask;  // valid bits of the last used word
+    int numTilesX;
+    int numTilesY;
+    int numActiveTiles;     // tiles computed in the last update
+    uint8_t* Changed;       // per tile, CHANGED_1 / CHANGED_2 : differs from generation t-1 / t-2, CHANGED_EDIT
+    uint8_t* NextChanged;
+    uint8_t* RowChanged;    // per row of tiles, some tile of the row has Changed set
+    uint8_t* NextRowChanged;
+    int* ActiveTiles;       // tile indices to compute this update
+    bool hasStats;
+    BitTileStats* Stats;        // per tile, generation in Front
+    BitTileStats* BackStats;    // per tile, generation in Back
+    uint64_t* Front;
+    uint64_t* Back;
+    bool isReserved;        // giant board, Front and Back committed by region
+    int numRegionsX;        // regions per row of tiles
+    bool* IsCommitted;      // per region
+    uint32_t* LastUsed;     // per region, numUpdates when an active tile last came near it
+    uint32_t numUpdates;
+    int numCommitted;       // regions committed now
+    int maxCommitted;       // most regions committed at once
+};
+
+bool InitBitBoard(BitBoard* board, int numXCells, int numYCells);
+void FreeBitBoard(BitBoard* board);
+bool UpdateBitBoard(BitBoard* board, ThreadPool* pool);
+int UpdateBitBoardTile(const BitBoard* board, int tileIdx);
+void MarkBitBoardChanged(BitBoard* board);
+void SwapBitBoard(BitBoard* board);
+void SetBitBoardStats(BitBoard* board, bool hasStats);
+void GetBitBoardStats(const BitBoard* board, LifeStats* stats);
+
+uint64_t GetBitBoardPopulation(const BitBoard* board);
+size_t GetBitBoardCommittedBytes(const BitBoard* board, bool isPeak);
+
+bool GetBitBoardCell(const BitBoard* board, int xidx, int yidx);
+void SetBitBoardCell(BitBoard* board, int xidx, int yidx, bool live);
+void LoadBitBoard(BitBoard* board, const bool* Cells);
+void StoreBitBoard(const BitBoard* board, bool* Cells);
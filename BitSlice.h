@@ -0,0 +1,98 @@
+#pragma once
+
+#include <stdint.h>
+#include "Rule.h"
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+/*
+Bit-sliced rule for 64 cells at once.
+The eight neighbour planes are added with full adders into a 4-bit count (s3 s2 s1 s0),
+RuleWord turns the count into the next generation, for B3/S23 count == 3, or count == 2 and alive now.
+*/
+template <int Birth, int Survival>
+inline uint64_t LifeWord(uint64_t uw, uint64_t u, uint64_t ue,
+                                uint64_t mw, uint64_t m, uint64_t me,
+                                uint64_t dw, uint64_t d, uint64_t de, Rule rule)
+{
+    // Rows above and below : full adders, middle row : half adder
+    uint64_t us = uw ^ u ^ ue;
+    uint64_t uc = (uw & u) | (ue & (uw ^ u));
+    uint64_t ds = dw ^ d ^ de;
+    uint64_t dc = (dw & d) | (de & (dw ^ d));
+    uint64_t ms = mw ^ me;
+    uint64_t mc = mw & me;
+
+    uint64_t s0 = us ^ ds ^ ms;
+    uint64_t c0 = (us & ds) | (ms & (us ^ ds));
+    uint64_t x1 = uc ^ dc ^ mc;
+    uint64_t c1 = (uc & dc) | (mc & (uc ^ dc));
+    uint64_t s1 = x1 ^ c0;
+    uint64_t c2 = x1 & c0;
+    uint64_t s2 = c1 ^ c2;
+    uint64_t s3 = c1 & c2;
+
+    return RuleWord<Birth, Survival>(s0, s1, s2, s3, m, rule);
+}
+
+// Neighbour of bit i is bit i-1 (West) or bit i+1 (East), carried across word boundaries
+inline uint64_t West(uint64_t w, uint64_t prev)
+{
+    return (w << 1) | (prev >> 63);
+}
+
+inline uint64_t East(uint64_t w, uint64_t next)
+{
+    return (w >> 1) | (next << 63);
+}
+
+// Index of the lowest set bit, w != 0
+inline int LowestBit(uint64_t w)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long idx;
+    _BitScanForward64(&idx, w);
+    return (int)idx;
+#else
+    return __builtin_ctzll(w);
+#endif
+}
+
+// Index of the highest set bit, w != 0
+inline int HighestBit(uint64_t w)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long idx;
+    _BitScanReverse64(&idx, w);
+    return (int)idx;
+#else
+    return 63 - __builtin_clzll(w);
+#endif
+}
+
+// POPCNT in functions compiled for it (target attribute), a library call in the others without -mpopcnt
+inline int PopCountNative(uint64_t w)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    return (int)__popcnt64(w);
+#else
+    return __builtin_popcountll(w);
+#endif
+}
+
+// Without POPCNT enabled GCC calls a library function, the SWAR sum stays inline
+inline int PopCount(uint64_t w)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    return (int)__popcnt64(w);
+#elif defined(__POPCNT__) || !(defined(__x86_64__) || defined(__i386__))
+    return __builtin_popcountll(w);
+#else
+    w = w - ((w >> 1) & 0x5555555555555555ULL);
+    w = (w & 0x3333333333333333ULL) + ((w >> 2) & 0x3333333333333333ULL);
+    w = (w + (w >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (int)((w * 0x0101010101010101ULL) >> 56);
+#endif
+}
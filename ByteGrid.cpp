@@ -0,0 +1,321 @@
+#include "ByteGrid.h"
+#include "CellKernel.h"
+#include "Memory.h"
+#include "Rule.h"
+#include "BitSlice.h"
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <random>
+#include <chrono>
+
+struct CellBands
+{
+    const bool* Cells;
+    bool* nextCells;
+    int numXCells;
+    int numYCells;
+    int rowAlign;
+    int numBands;
+};
+
+static void UpdateCellBand(void* context, int taskIdx, int threadIdx)
+{
+    const CellBands* bands = (const CellBands*)context;
+    int yBegin, yEnd;
+
+    GetBandRows(bands->numYCells, bands->rowAlign, bands->numBands, taskIdx, &yBegin, &yEnd);
+    UpdateCellRows(bands->Cells, bands->nextCells, yBegin, yEnd, bands->numXCells, bands->numYCells);
+}
+
+/*
+Writes the next generation of Cells into nextCells, the caller swaps the two buffers.
+With a pool, rows are split into one band per thread and every band starts on a cache line.
+*/
+bool UpdateCell(const bool* Cells, bool* nextCells, int numXCells, int numYCells, ThreadPool* pool)
+{
+    if (Cells == NULL || nextCells == NULL)
+    {
+        printf("UpdateCell fail\n");
+        return false;
+    }
+
+    if (pool != NULL && pool->numThreads > 1)
+    {
+        // Even rows keep the row pairs of the 4x4 table kernel inside one band
+        CellBands bands = { Cells, nextCells, numXCells, numYCells, 2, pool->numThreads };
+        while ((bands.rowAlign * numXCells) % CACHE_LINE != 0)
+            bands.rowAlign *= 2;
+        RunThreadPool(pool, UpdateCellBand, &bands, bands.numBands);
+    }
+    else
+    {
+        UpdateCellRows(Cells, nextCells, 0, numYCells, numXCells, numYCells);
+    }
+
+    return true;
+}
+
+bool InitCellTiles(CellTiles* tiles, int numXCells, int numYCells, int numThreads)
+{
+    tiles->numXCells = numXCells;
+    tiles->numYCells = numYCells;
+    tiles->numTilesY = (numYCells + CELL_TILE_Y - 1) / CELL_TILE_Y;
+    tiles->numThreads = numThreads > 0 ? numThreads : 1;
+    SetCellTilesStep(tiles, 0);
+
+    // One row more for the halo rounded down to an even row
+    int maxHalo = 1 << CELL_MAX_STEP_LOG2;
+    tiles->scratchSize = (size_t)(CELL_TILE_X + 2) * (CELL_TILE_Y + 2 * maxHalo + 1);
+    tiles->Scratch = (bool*)LifeAlloc(tiles->scratchSize * 2 * tiles->numThreads * sizeof(bool));
+    if (tiles->Scratch == NULL)
+    {
+        printf("InitCellTiles LifeAlloc fail\n");
+        return false;
+    }
+    memset(tiles->Scratch, 0, tiles->scratchSize * 2 * tiles->numThreads * sizeof(bool));
+
+    return true;
+}
+
+void FreeCellTiles(CellTiles* tiles)
+{
+    LifeFree(tiles->Scratch);
+    tiles->Scratch = NULL;
+}
+
+bool SetCellTilesStep(CellTiles* tiles, int stepLog2)
+{
+    if (stepLog2 < 0 || stepLog2 > CELL_MAX_STEP_LOG2)
+        return false;
+    tiles->stepLog2 = stepLog2;
+    tiles->tileWidth = CELL_TILE_X + 2 - 2 * (1 << stepLog2);
+    tiles->numTilesX = (tiles->numXCells + tiles->tileWidth - 1) / tiles->tileWidth;
+    return true;
+}
+
+struct CellTileTask
+{
+    const CellTiles* tiles;
+    const bool* Cells;
+    bool* nextCells;
+};
+
+static void UpdateCellTile(void* context, int taskIdx, int threadIdx)
+{
+    const CellTileTask* task = (const CellTileTask*)context;
+    const CellTiles* tiles = task->tiles;
+    int numXCells = tiles->numXCells;
+    int numYCells = tiles->numYCells;
+    int numSteps = 1 << tiles->stepLog2;
+
+    int xBegin = (taskIdx % tiles->numTilesX) * tiles->tileWidth;
+    int yBegin = (taskIdx / tiles->numTilesX) * CELL_TILE_Y;
+    int xEnd = std::min(xBegin + tiles->tileWidth, numXCells);
+    int yEnd = std::min(yBegin + CELL_TILE_Y, numYCells);
+
+    // Widened to 64n + 2 columns, at the right edge to the left, so the SIMD kernels leave only the
+    // edge columns to CheckRule, scratch rows keep the parity of the grid rows for hexagonal rules
+    int x0 = std::max(xBegin - numSteps, 0);
+    int x1 = std::min(xEnd + numSteps, numXCells);
+    int width = std::min(((x1 - x0 + 61) & ~63) + 2, numXCells);
+    x1 = std::min(x0 + width, numXCells);
+    x0 = x1 - width;
+    int y0 = std::max(yBegin - numSteps, 0) & ~1;
+    int y1 = std::min(yEnd + numSteps, numYCells);
+    int height = y1 - y0;
+
+    bool* Front = tiles->Scratch + tiles->scratchSize * 2 * threadIdx;
+    bool* Back = Front + tiles->scratchSize;
+    for (int yidx = y0; yidx < y1; yidx++)
+        memcpy(Front + (size_t)width * (yidx - y0), task->Cells + (size_t)numXCells * yidx + x0, width * sizeof(bool));
+
+    for (int step = 1; step <= numSteps; step++)
+    {
+        int margin = numSteps - step;
+        int yFirst = std::max(yBegin - margin, y0) - y0;
+        int yLast = std::min(yEnd + margin, y1) - y0;
+        UpdateCellRows(Front, Back, yFirst, yLast, width, height);
+        bool* tmp = Front;
+        Front = Back;
+        Back = tmp;
+    }
+
+    for (int yidx = yBegin; yidx < yEnd; yidx++)
+        memcpy(task->nextCells + (size_t)numXCells * yidx + xBegin, Front + (size_t)width * (yidx - y0) + (xBegin - x0),
+            (xEnd - xBegin) * sizeof(bool));
+}
+
+// Writes generation 2^stepLog2 after Cells into nextCells, tiles are handed out to the threads of the pool
+bool UpdateCellTiles(CellTiles* tiles, const bool* Cells, bool* nextCells, ThreadPool* pool)
+{
+    if (Cells == NULL || nextCells == NULL || tiles->Scratch == NULL)
+    {
+        printf("UpdateCellTiles fail\n");
+        return false;
+    }
+
+    CellTileTask task = { tiles, Cells, nextCells };
+    int numTiles = tiles->numTilesX * tiles->numTilesY;
+    if (pool != NULL && pool->numThreads > 1 && pool->numThreads <= tiles->numThreads)
+    {
+        RunThreadPool(pool, UpdateCellTile, &task, numTiles);
+    }
+    else
+    {
+        for (int tile = 0; tile < numTiles; tile++)
+            UpdateCellTile(&task, tile, 0);
+    }
+
+    return true;
+}
+
+/*
+Any live cell with fewer than two live neighbours dies, as if by underpopulation.
+Any live cell with two or three live neighbours lives on to the next generation.
+Any live cell with more than three live neighbours dies, as if by overpopulation.
+Any dead cell with exactly three live neighbours becomes a live cell, as if by reproduction.
+Other life-like rules replace the counts with the birth / survival masks of SetRule,
+rules in Hensel notation look the whole neighbourhood up.
+*/
+bool CheckRule(const bool* Cells, int xidx, int yidx, int width, int height)
+{
+    // Window Boundary Rule
+    int xm = std::max(xidx - 1, 0);
+    int x0 = xidx;
+    int xp = std::min(xidx + 1, width - 1);
+    int ym = std::max(yidx - 1, 0);
+    int y0 = yidx;
+    int yp = std::min(yidx + 1, height - 1);
+    bool islive = Cells[x0 + width * y0];
+
+    // Hensel notation : the arrangement matters, index bit (3 * column + row) as in LifeTable.h
+    Rule rule = GetRule();
+    if (rule.isIsotropic)
+    {
+        int index512 = Cells[xm + width * ym] | Cells[xm + width * y0] << 1 | Cells[xm + width * yp] << 2 |
+            Cells[x0 + width * ym] << 3 | islive << 4 | Cells[x0 + width * yp] << 5 |
+            Cells[xp + width * ym] << 6 | Cells[xp + width * y0] << 7 | Cells[xp + width * yp] << 8;
+        return IsNextLive512(rule, index512);
+    }
+
+    // Von Neumann : the 4 orthogonal neighbours, hexagonal : odd rows sit half a cell right of even rows
+    if (rule.neighbourhood == NEIGHBOURHOOD_VON_NEUMANN)
+    {
+        int numNeighbours = Cells[x0 + width * ym] + Cells[xm + width * y0] + Cells[xp + width * y0] + Cells[x0 + width * yp];
+        return IsNextLive(rule, islive, numNeighbours);
+    }
+    if (rule.neighbourhood == NEIGHBOURHOOD_HEXAGONAL)
+    {
+        int xl = (yidx & 1) ? x0 : xm;
+        int xr = (yidx & 1) ? xp : x0;
+        int numNeighbours = Cells[xl + width * ym] + Cells[xr + width * ym] +
+            Cells[xm + width * y0] + Cells[xp + width * y0] +
+            Cells[xl + width * yp] + Cells[xr + width * yp];
+        return IsNextLive(rule, islive, numNeighbours);
+    }
+
+    int numNeighbours = Cells[xm + width * ym] +
+        Cells[x0 + width * ym] +
+        Cells[xp + width * ym] +
+        Cells[xm + width * y0] +
+        Cells[xp + width * y0] +
+        Cells[xm + width * yp] +
+        Cells[x0 + width * yp] +
+        Cells[xp + width * yp];
+
+    return IsNextLive(rule, islive, numNeighbours);
+}
+
+// 64-bit seed from the OS entropy source and the clock, printed so the board can be seeded again
+uint64_t GetRandomSeed()
+{
+    std::random_device rd;
+    uint64_t seed = ((uint64_t)rd() << 32) ^ rd();
+    return seed ^ (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+}
+
+// Output counter of the SplitMix64 stream of seed, any word is drawn without the ones before it
+uint64_t GetSeedWord(uint64_t seed, uint64_t counter)
+{
+    uint64_t z = seed + (counter + 1) * 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/*
+64 cells live with probability threshold / 256 each : the bits of threshold from the lowest set one up
+OR (bit 1) or AND (bit 0) a new random word in, every step halves the odds and adds 1/2 for a 1 bit.
+Density 1/2 takes one draw, 1/256 steps eight.
+*/
+static inline uint64_t GetDensityWord(uint64_t seed, uint64_t block, int threshold)
+{
+    if (threshold <= 0)
+        return 0;
+    if (threshold >= 1 << SEED_DENSITY_BITS)
+        return ~0ULL;
+
+    uint64_t word = 0;
+    for (int bit = LowestBit(threshold); bit < SEED_DENSITY_BITS; bit++)
+    {
+        uint64_t draw = GetSeedWord(seed, block * SEED_DENSITY_BITS + bit);
+        word = ((threshold >> bit) & 1) ? (word | draw) : (word & draw);
+    }
+    return word;
+}
+
+struct SeedBands
+{
+    bool* Cells;
+    int numXCells;
+    int numYCells;
+    uint64_t seed;
+    int threshold;
+    int numBands;
+};
+
+// Cell idx is bit (idx % 64) of word idx / 64, so the board does not depend on the bands
+static void SetCellBand(void* context, int taskIdx, int threadIdx)
+{
+    const SeedBands* bands = (const SeedBands*)context;
+    int yBegin, yEnd;
+
+    GetBandRows(bands->numYCells, 1, bands->numBands, taskIdx, &yBegin, &yEnd);
+    size_t end = (size_t)bands->numXCells * yEnd;
+    for (size_t idx = (size_t)bands->numXCells * yBegin; idx < end;)
+    {
+        uint64_t block = idx >> 6;
+        uint64_t word = GetDensityWord(bands->seed, block, bands->threshold);
+        size_t blockEnd = std::min((size_t)(block + 1) << 6, end);
+        for (; idx < blockEnd; idx++)
+        {
+            bands->Cells[idx] = (word >> (idx & 63)) & 1;
+        }
+    }
+}
+
+/*
+Random board of the given density, row-major, 64 cells per draw of a counter-based generator.
+The same seed and density give the same board with any number of threads, a pool splits the rows.
+*/
+bool SetCells(bool* Cells, int numXCells, int numYCells, uint64_t seed, double density, ThreadPool* pool)
+{
+    if (Cells == NULL)
+        return false;
+
+    int threshold = (int)(density * (1 << SEED_DENSITY_BITS) + 0.5);
+    threshold = std::min(std::max(threshold, 0), 1 << SEED_DENSITY_BITS);
+    SeedBands bands = { Cells, numXCells, numYCells, seed, threshold, 1 };
+    if (pool != NULL && pool->numThreads > 1)
+    {
+        bands.numBands = pool->numThreads;
+        RunThreadPool(pool, SetCellBand, &bands, bands.numBands);
+    }
+    else
+    {
+        SetCellBand(&bands, 0, 0);
+    }
+
+    return true;
+}
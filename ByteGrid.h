@@ -0,0 +1,47 @@
+#pragma once
+
+#include "ThreadPool.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#define CELL_TILE_X 1024            // temporal blocking tile, tile and halo are CELL_TILE_X + 2 columns
+#define CELL_TILE_Y 128             // rows, the halo comes on top of them
+#define CELL_MAX_STEP_LOG2 3        // up to 8 generations per pass over the grid
+#define SEED_DENSITY_BITS 8         // SetCells density in steps of 1/256
+#define SEED_DENSITY 0.5
+
+/*
+The byte grid : one bool per cell, Cells[x + numXCells * y], stepped by the row kernels of CellKernel.h.
+CheckRule is the reference every engine is compared against, the cell beyond an edge is the edge cell.
+Nothing here depends on SDL, the window, the benchmark and the headless runner share it.
+*/
+bool UpdateCell(const bool* Cells, bool* nextCells, int numXCells, int numYCells, ThreadPool* pool);
+bool CheckRule(const bool* Cells, int xidx, int yidx, int width, int height);
+uint64_t GetRandomSeed();
+uint64_t GetSeedWord(uint64_t seed, uint64_t counter);
+bool SetCells(bool* Cells, int numXCells, int numYCells, uint64_t seed, double density, ThreadPool* pool);
+
+/*
+Temporal blocking : every tile is copied with a halo of k = 2^stepLog2 cells into a scratch board
+of its thread and advanced k generations there before its interior is written back, so the grid
+goes through memory once per k generations instead of once per generation.
+The scratch board clamps at its own edges like CheckRule, the error this makes inside the grid moves
+one cell per generation and never reaches the tile, the rows computed shrink by one every generation.
+*/
+struct CellTiles
+{
+    int numXCells;
+    int numYCells;
+    int tileWidth;      // CELL_TILE_X + 2 - 2k : the SIMD kernels leave only the edge columns to CheckRule
+    int numTilesX;
+    int numTilesY;
+    int numThreads;
+    int stepLog2;       // 0 : UpdateCell, no tiles
+    size_t scratchSize; // cells of one scratch board
+    bool* Scratch;      // two scratch boards per thread
+};
+
+bool InitCellTiles(CellTiles* tiles, int numXCells, int numYCells, int numThreads);
+void FreeCellTiles(CellTiles* tiles);
+bool SetCellTilesStep(CellTiles* tiles, int stepLog2);
+bool UpdateCellTiles(CellTiles* tiles, const bool* Cells, bool* nextCells, ThreadPool* pool);
@@ -0,0 +1,698 @@
+#include "CellKernel.h"
+#include "LifeTable.h"
+#include "Rule.h"
+#include "ByteGrid.h"
+#include <stdio.h>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define CELL_KERNEL_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#else
+#define CELL_KERNEL_X86 0
+#endif
+
+// MSVC compiles any intrinsic as is, GCC and Clang need the ISA enabled per function
+#if defined(_MSC_VER) && !defined(__clang__)
+#define TARGET_SSE2
+#define TARGET_AVX2
+#define TARGET_AVX512
+#else
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#define TARGET_AVX512 __attribute__((target("avx512f")))
+#endif
+
+typedef void (*CellRowFunction)(const bool* Cells, bool* nextCells, int yidx, int width, int height);
+
+// Row range kernel from a single row function
+template <CellRowFunction UpdateRow>
+static void UpdateRows(const bool* Cells, bool* nextCells, int yBegin, int yEnd, int width, int height)
+{
+    for (int yidx = yBegin; yidx < yEnd; yidx++)
+    {
+        UpdateRow(Cells, nextCells, yidx, width, height);
+    }
+}
+
+static void UpdateRowScalar(const bool* Cells, bool* nextCells, int yidx, int width, int height)
+{
+    for (int xidx = 0; xidx < width; xidx++)
+    {
+        nextCells[xidx + width * yidx] = CheckRule(Cells, xidx, yidx, width, height);
+    }
+}
+
+static constexpr LifeTable512 LifeTable512Life(RULE_B3, RULE_S23);
+static constexpr LifeTable4x4 LifeTable4x4Life(RULE_B3, RULE_S23);
+
+// Other rules get their tables built by SetCellKernel, the compile time ones stay for B3/S23
+static LifeTable512 RuleTable512;
+static LifeTable4x4 RuleTable4x4;
+static const LifeTable512* Table512 = &LifeTable512Life;
+static const LifeTable4x4* Table4x4 = &LifeTable4x4Life;
+static int32_t GatherTable512[512];     // 32-bit entries of the 512 table for the gather kernels
+
+/*
+The 3x3 index slides along the row 3 bits at a time : every column holds (up, mid, down) in 3 bits.
+Window Boundary Rule : the column beyond the edge is the edge column, rows are clamped as in CheckRule.
+*/
+static void UpdateRowLUT512(const bool* Cells, bool* nextCells, int yidx, int width, int height)
+{
+    const bool* up = Cells + width * (yidx > 0 ? yidx - 1 : 0);
+    const bool* mid = Cells + width * yidx;
+    const bool* down = Cells + width * (yidx < height - 1 ? yidx + 1 : height - 1);
+    bool* out = nextCells + width * yidx;
+
+    // Columns -1 (clamped to 0) and 0
+    int column = up[0] | mid[0] << 1 | down[0] << 2;
+    int index = column << 3 | column << 6;
+    for (int xidx = 0; xidx < width; xidx++)
+    {
+        int xp = xidx < width - 1 ? xidx + 1 : width - 1;
+        index = (index >> 3) | (up[xp] | mid[xp] << 1 | down[xp] << 2) << 6;
+        out[xidx] = Table512->Next[index];
+    }
+}
+
+/*
+Two rows at a time : the 4x4 index slides along the row pair 2 columns (8 bits) at a time and every lookup
+gives the 2x2 cells (xidx, xidx + 1) x (yidx, yidx + 1). An odd last row goes through the 512 table.
+*/
+static void UpdateRowsLUT4x4(const bool* Cells, bool* nextCells, int yBegin, int yEnd, int width, int height)
+{
+    int yidx = yBegin;
+    for (; yidx + 1 < yEnd; yidx += 2)
+    {
+        const bool* r0 = Cells + width * (yidx > 0 ? yidx - 1 : 0);
+        const bool* r1 = Cells + width * yidx;
+        const bool* r2 = Cells + width * (yidx + 1);
+        const bool* r3 = Cells + width * (yidx + 2 < height ? yidx + 2 : height - 1);
+        bool* out0 = nextCells + width * yidx;
+        bool* out1 = nextCells + width * (yidx + 1);
+
+        // Columns -1 (clamped to 0) and 0
+        int column = r0[0] | r1[0] << 1 | r2[0] << 2 | r3[0] << 3;
+        int index = column << 8 | column << 12;
+        for (int xidx = 0; xidx < width; xidx += 2)
+        {
+            int x1 = xidx + 1 < width ? xidx + 1 : width - 1;
+            int x2 = xidx + 2 < width ? xidx + 2 : width - 1;
+            index = (index >> 8) |
+                (r0[x1] | r1[x1] << 1 | r2[x1] << 2 | r3[x1] << 3) << 8 |
+                (r0[x2] | r1[x2] << 1 | r2[x2] << 2 | r3[x2] << 3) << 12;
+
+            int next = Table4x4->Next[index];
+            out0[xidx] = next & 1;
+            out1[xidx] = (next >> 2) & 1;
+            if (xidx + 1 < width)
+            {
+                out0[xidx + 1] = (next >> 1) & 1;
+                out1[xidx + 1] = (next >> 3) & 1;
+            }
+        }
+    }
+
+    if (yidx < yEnd)
+        UpdateRowLUT512(Cells, nextCells, yidx, width, height);
+}
+
+#if CELL_KERNEL_X86
+
+/*
+Each byte of a bool grid is 0 or 1, so the bitwise full adders of the BitBoard work on bytes as well
+and the result stays 0 or 1 without any compare. Only the edge columns x = 0 and width - 1 go through
+CheckRule : the row ends with a vector overlapping the one before it, narrow rows step down to narrower vectors.
+The rule functions take the count as s0, s1 and the two carries c1, c2 (s2 = c1 ^ c2, s3 = c1 & c2) and
+match it against the count masks as RuleWord does, B3/S23 keeps its shortcut : s1 and no carry, and s0 or alive.
+*/
+TARGET_SSE2 static inline __m128i RuleSSE2Runtime(__m128i s0, __m128i s1, __m128i c1, __m128i c2, __m128i m,
+                                                  int birth, int survival)
+{
+    __m128i s[4] = { s0, s1, _mm_xor_si128(c1, c2), _mm_and_si128(c1, c2) };
+    __m128i born = _mm_setzero_si128(), survive = _mm_setzero_si128();
+    for (int count = 0; count <= 8; count++)
+    {
+        if ((((birth | survival) >> count) & 1) == 0)
+            continue;
+        __m128i match = _mm_set1_epi8(1);
+        for (int bit = 0; bit < 4; bit++)
+        {
+            match = ((count >> bit) & 1) ? _mm_and_si128(match, s[bit]) : _mm_andnot_si128(s[bit], match);
+        }
+        if ((birth >> count) & 1)
+            born = _mm_or_si128(born, match);
+        if ((survival >> count) & 1)
+            survive = _mm_or_si128(survive, match);
+    }
+    return _mm_or_si128(_mm_andnot_si128(m, born), _mm_and_si128(survive, m));
+}
+
+template <int Birth, int Survival>
+TARGET_SSE2 static inline __m128i RuleSSE2(__m128i s0, __m128i s1, __m128i c1, __m128i c2, __m128i m, Rule rule)
+{
+    return RuleSSE2Runtime(s0, s1, c1, c2, m, Birth == RULE_RUNTIME ? rule.birth : Birth,
+        Survival == RULE_RUNTIME ? rule.survival : Survival);
+}
+
+template <>
+TARGET_SSE2 inline __m128i RuleSSE2<RULE_B3, RULE_S23>(__m128i s0, __m128i s1, __m128i c1, __m128i c2, __m128i m, Rule rule)
+{
+    return _mm_andnot_si128(_mm_or_si128(c1, c2), _mm_and_si128(s1, _mm_or_si128(s0, m)));
+}
+
+TARGET_AVX2 static inline __m256i RuleAVX2Runtime(__m256i s0, __m256i s1, __m256i c1, __m256i c2, __m256i m,
+                                                  int birth, int survival)
+{
+    __m256i s[4] = { s0, s1, _mm256_xor_si256(c1, c2), _mm256_and_si256(c1, c2) };
+    __m256i born = _mm256_setzero_si256(), survive = _mm256_setzero_si256();
+    for (int count = 0; count <= 8; count++)
+    {
+        if ((((birth | survival) >> count) & 1) == 0)
+            continue;
+        __m256i match = _mm256_set1_epi8(1);
+        for (int bit = 0; bit < 4; bit++)
+        {
+            match = ((count >> bit) & 1) ? _mm256_and_si256(match, s[bit]) : _mm256_andnot_si256(s[bit], match);
+        }
+        if ((birth >> count) & 1)
+            born = _mm256_or_si256(born, match);
+        if ((survival >> count) & 1)
+            survive = _mm256_or_si256(survive, match);
+    }
+    return _mm256_or_si256(_mm256_andnot_si256(m, born), _mm256_and_si256(survive, m));
+}
+
+template <int Birth, int Survival>
+TARGET_AVX2 static inline __m256i RuleAVX2(__m256i s0, __m256i s1, __m256i c1, __m256i c2, __m256i m, Rule rule)
+{
+    return RuleAVX2Runtime(s0, s1, c1, c2, m, Birth == RULE_RUNTIME ? rule.birth : Birth,
+        Survival == RULE_RUNTIME ? rule.survival : Survival);
+}
+
+template <>
+TARGET_AVX2 inline __m256i RuleAVX2<RULE_B3, RULE_S23>(__m256i s0, __m256i s1, __m256i c1, __m256i c2, __m256i m, Rule rule)
+{
+    return _mm256_andnot_si256(_mm256_or_si256(c1, c2), _mm256_and_si256(s1, _mm256_or_si256(s0, m)));
+}
+
+TARGET_AVX512 static inline __m512i RuleAVX512Runtime(__m512i s0, __m512i s1, __m512i c1, __m512i c2, __m512i m,
+                                                      int birth, int survival)
+{
+    __m512i s[4] = { s0, s1, _mm512_xor_si512(c1, c2), _mm512_and_si512(c1, c2) };
+    __m512i born = _mm512_setzero_si512(), survive = _mm512_setzero_si512();
+    for (int count = 0; count <= 8; count++)
+    {
+        if ((((birth | survival) >> count) & 1) == 0)
+            continue;
+        __m512i match = _mm512_set1_epi32(0x01010101);
+        for (int bit = 0; bit < 4; bit++)
+        {
+            match = ((count >> bit) & 1) ? _mm512_and_si512(match, s[bit]) : _mm512_andnot_si512(s[bit], match);
+        }
+        if ((birth >> count) & 1)
+            born = _mm512_or_si512(born, match);
+        if ((survival >> count) & 1)
+            survive = _mm512_or_si512(survive, match);
+    }
+    return _mm512_or_si512(_mm512_andnot_si512(m, born), _mm512_and_si512(survive, m));
+}
+
+template <int Birth, int Survival>
+TARGET_AVX512 static inline __m512i RuleAVX512(__m512i s0, __m512i s1, __m512i c1, __m512i c2, __m512i m, Rule rule)
+{
+    return RuleAVX512Runtime(s0, s1, c1, c2, m, Birth == RULE_RUNTIME ? rule.birth : Birth,
+        Survival == RULE_RUNTIME ? rule.survival : Survival);
+}
+
+template <>
+TARGET_AVX512 inline __m512i RuleAVX512<RULE_B3, RULE_S23>(__m512i s0, __m512i s1, __m512i c1, __m512i c2, __m512i m, Rule rule)
+{
+    return _mm512_andnot_si512(_mm512_or_si512(c1, c2), _mm512_and_si512(s1, _mm512_or_si512(s0, m)));
+}
+
+template <int Birth, int Survival>
+TARGET_SSE2 static inline void UpdateVectorSSE2(const char* up, const char* mid, const char* down, char* out, int xidx,
+    Rule rule)
+{
+    __m128i uw = _mm_loadu_si128((const __m128i*)(up + xidx - 1));
+    __m128i u = _mm_loadu_si128((const __m128i*)(up + xidx));
+    __m128i ue = _mm_loadu_si128((const __m128i*)(up + xidx + 1));
+    __m128i mw = _mm_loadu_si128((const __m128i*)(mid + xidx - 1));
+    __m128i m = _mm_loadu_si128((const __m128i*)(mid + xidx));
+    __m128i me = _mm_loadu_si128((const __m128i*)(mid + xidx + 1));
+    __m128i dw = _mm_loadu_si128((const __m128i*)(down + xidx - 1));
+    __m128i d = _mm_loadu_si128((const __m128i*)(down + xidx));
+    __m128i de = _mm_loadu_si128((const __m128i*)(down + xidx + 1));
+
+    __m128i us = _mm_xor_si128(_mm_xor_si128(uw, u), ue);
+    __m128i uc = _mm_or_si128(_mm_and_si128(uw, u), _mm_and_si128(ue, _mm_xor_si128(uw, u)));
+    __m128i ds = _mm_xor_si128(_mm_xor_si128(dw, d), de);
+    __m128i dc = _mm_or_si128(_mm_and_si128(dw, d), _mm_and_si128(de, _mm_xor_si128(dw, d)));
+    __m128i ms = _mm_xor_si128(mw, me);
+    __m128i mc = _mm_and_si128(mw, me);
+
+    __m128i s0 = _mm_xor_si128(_mm_xor_si128(us, ds), ms);
+    __m128i c0 = _mm_or_si128(_mm_and_si128(us, ds), _mm_and_si128(ms, _mm_xor_si128(us, ds)));
+    __m128i x1 = _mm_xor_si128(_mm_xor_si128(uc, dc), mc);
+    __m128i c1 = _mm_or_si128(_mm_and_si128(uc, dc), _mm_and_si128(mc, _mm_xor_si128(uc, dc)));
+    __m128i s1 = _mm_xor_si128(x1, c0);
+    __m128i c2 = _mm_and_si128(x1, c0);
+
+    __m128i live = RuleSSE2<Birth, Survival>(s0, s1, c1, c2, m, rule);
+    _mm_storeu_si128((__m128i*)(out + xidx), live);
+}
+
+template <int Birth, int Survival>
+TARGET_SSE2 static inline int UpdateSpanSSE2(const char* up, const char* mid, const char* down, char* out, int xidx, int width,
+    Rule rule)
+{
+    for (; xidx + 16 < width; xidx += 16)
+    {
+        UpdateVectorSSE2<Birth, Survival>(up, mid, down, out, xidx, rule);
+    }
+    if (xidx < width - 1 && width >= 18)
+    {
+        UpdateVectorSSE2<Birth, Survival>(up, mid, down, out, width - 17, rule);
+        xidx = width - 1;
+    }
+    return xidx;
+}
+
+template <int Birth, int Survival>
+TARGET_SSE2 static void UpdateRowSSE2(const bool* Cells, bool* nextCells, int yidx, int width, int height)
+{
+    const char* up = (const char*)Cells + width * (yidx > 0 ? yidx - 1 : 0);
+    const char* mid = (const char*)Cells + width * yidx;
+    const char* down = (const char*)Cells + width * (yidx < height - 1 ? yidx + 1 : height - 1);
+    char* out = (char*)nextCells + width * yidx;
+
+    int xidx = UpdateSpanSSE2<Birth, Survival>(up, mid, down, out, 1, width, GetRule());
+    nextCells[width * yidx] = CheckRule(Cells, 0, yidx, width, height);
+    for (; xidx < width; xidx++)
+    {
+        nextCells[xidx + width * yidx] = CheckRule(Cells, xidx, yidx, width, height);
+    }
+}
+
+template <int Birth, int Survival>
+TARGET_AVX2 static inline void UpdateVectorAVX2(const char* up, const char* mid, const char* down, char* out, int xidx,
+    Rule rule)
+{
+    __m256i uw = _mm256_loadu_si256((const __m256i*)(up + xidx - 1));
+    __m256i u = _mm256_loadu_si256((const __m256i*)(up + xidx));
+    __m256i ue = _mm256_loadu_si256((const __m256i*)(up + xidx + 1));
+    __m256i mw = _mm256_loadu_si256((const __m256i*)(mid + xidx - 1));
+    __m256i m = _mm256_loadu_si256((const __m256i*)(mid + xidx));
+    __m256i me = _mm256_loadu_si256((const __m256i*)(mid + xidx + 1));
+    __m256i dw = _mm256_loadu_si256((const __m256i*)(down + xidx - 1));
+    __m256i d = _mm256_loadu_si256((const __m256i*)(down + xidx));
+    __m256i de = _mm256_loadu_si256((const __m256i*)(down + xidx + 1));
+
+    __m256i us = _mm256_xor_si256(_mm256_xor_si256(uw, u), ue);
+    __m256i uc = _mm256_or_si256(_mm256_and_si256(uw, u), _mm256_and_si256(ue, _mm256_xor_si256(uw, u)));
+    __m256i ds = _mm256_xor_si256(_mm256_xor_si256(dw, d), de);
+    __m256i dc = _mm256_or_si256(_mm256_and_si256(dw, d), _mm256_and_si256(de, _mm256_xor_si256(dw, d)));
+    __m256i ms = _mm256_xor_si256(mw, me);
+    __m256i mc = _mm256_and_si256(mw, me);
+
+    __m256i s0 = _mm256_xor_si256(_mm256_xor_si256(us, ds), ms);
+    __m256i c0 = _mm256_or_si256(_mm256_and_si256(us, ds), _mm256_and_si256(ms, _mm256_xor_si256(us, ds)));
+    __m256i x1 = _mm256_xor_si256(_mm256_xor_si256(uc, dc), mc);
+    __m256i c1 = _mm256_or_si256(_mm256_and_si256(uc, dc), _mm256_and_si256(mc, _mm256_xor_si256(uc, dc)));
+    __m256i s1 = _mm256_xor_si256(x1, c0);
+    __m256i c2 = _mm256_and_si256(x1, c0);
+
+    __m256i live = RuleAVX2<Birth, Survival>(s0, s1, c1, c2, m, rule);
+    _mm256_storeu_si256((__m256i*)(out + xidx), live);
+}
+
+template <int Birth, int Survival>
+TARGET_AVX2 static inline int UpdateSpanAVX2(const char* up, const char* mid, const char* down, char* out, int xidx, int width,
+    Rule rule)
+{
+    for (; xidx + 32 < width; xidx += 32)
+    {
+        UpdateVectorAVX2<Birth, Survival>(up, mid, down, out, xidx, rule);
+    }
+    if (xidx < width - 1 && width >= 34)
+    {
+        UpdateVectorAVX2<Birth, Survival>(up, mid, down, out, width - 33, rule);
+        xidx = width - 1;
+    }
+    else if (xidx < width - 1)
+    {
+        xidx = UpdateSpanSSE2<Birth, Survival>(up, mid, down, out, xidx, width, rule);
+    }
+    return xidx;
+}
+
+template <int Birth, int Survival>
+TARGET_AVX2 static void UpdateRowAVX2(const bool* Cells, bool* nextCells, int yidx, int width, int height)
+{
+    const char* up = (const char*)Cells + width * (yidx > 0 ? yidx - 1 : 0);
+    const char* mid = (const char*)Cells + width * yidx;
+    const char* down = (const char*)Cells + width * (yidx < height - 1 ? yidx + 1 : height - 1);
+    char* out = (char*)nextCells + width * yidx;
+
+    int xidx = UpdateSpanAVX2<Birth, Survival>(up, mid, down, out, 1, width, GetRule());
+    nextCells[width * yidx] = CheckRule(Cells, 0, yidx, width, height);
+    for (; xidx < width; xidx++)
+    {
+        nextCells[xidx + width * yidx] = CheckRule(Cells, xidx, yidx, width, height);
+    }
+}
+
+// AVX-512F has no byte arithmetic, but the adders only need and/or/xor which are lane-size agnostic
+template <int Birth, int Survival>
+TARGET_AVX512 static inline void UpdateVectorAVX512(const char* up, const char* mid, const char* down, char* out, int xidx,
+    Rule rule)
+{
+    __m512i uw = _mm512_loadu_si512((const void*)(up + xidx - 1));
+    __m512i u = _mm512_loadu_si512((const void*)(up + xidx));
+    __m512i ue = _mm512_loadu_si512((const void*)(up + xidx + 1));
+    __m512i mw = _mm512_loadu_si512((const void*)(mid + xidx - 1));
+    __m512i m = _mm512_loadu_si512((const void*)(mid + xidx));
+    __m512i me = _mm512_loadu_si512((const void*)(mid + xidx + 1));
+    __m512i dw = _mm512_loadu_si512((const void*)(down + xidx - 1));
+    __m512i d = _mm512_loadu_si512((const void*)(down + xidx));
+    __m512i de = _mm512_loadu_si512((const void*)(down + xidx + 1));
+
+    __m512i us = _mm512_xor_si512(_mm512_xor_si512(uw, u), ue);
+    __m512i uc = _mm512_or_si512(_mm512_and_si512(uw, u), _mm512_and_si512(ue, _mm512_xor_si512(uw, u)));
+    __m512i ds = _mm512_xor_si512(_mm512_xor_si512(dw, d), de);
+    __m512i dc = _mm512_or_si512(_mm512_and_si512(dw, d), _mm512_and_si512(de, _mm512_xor_si512(dw, d)));
+    __m512i ms = _mm512_xor_si512(mw, me);
+    __m512i mc = _mm512_and_si512(mw, me);
+
+    __m512i s0 = _mm512_xor_si512(_mm512_xor_si512(us, ds), ms);
+    __m512i c0 = _mm512_or_si512(_mm512_and_si512(us, ds), _mm512_and_si512(ms, _mm512_xor_si512(us, ds)));
+    __m512i x1 = _mm512_xor_si512(_mm512_xor_si512(uc, dc), mc);
+    __m512i c1 = _mm512_or_si512(_mm512_and_si512(uc, dc), _mm512_and_si512(mc, _mm512_xor_si512(uc, dc)));
+    __m512i s1 = _mm512_xor_si512(x1, c0);
+    __m512i c2 = _mm512_and_si512(x1, c0);
+
+    __m512i live = RuleAVX512<Birth, Survival>(s0, s1, c1, c2, m, rule);
+    _mm512_storeu_si512((void*)(out + xidx), live);
+}
+
+template <int Birth, int Survival>
+TARGET_AVX512 static inline int UpdateSpanAVX512(const char* up, const char* mid, const char* down, char* out, int xidx, int width,
+    Rule rule)
+{
+    for (; xidx + 64 < width; xidx += 64)
+    {
+        UpdateVectorAVX512<Birth, Survival>(up, mid, down, out, xidx, rule);
+    }
+    if (xidx < width - 1 && width >= 66)
+    {
+        UpdateVectorAVX512<Birth, Survival>(up, mid, down, out, width - 65, rule);
+        xidx = width - 1;
+    }
+    else if (xidx < width - 1)
+    {
+        xidx = UpdateSpanAVX2<Birth, Survival>(up, mid, down, out, xidx, width, rule);
+    }
+    return xidx;
+}
+
+template <int Birth, int Survival>
+TARGET_AVX512 static void UpdateRowAVX512(const bool* Cells, bool* nextCells, int yidx, int width, int height)
+{
+    const char* up = (const char*)Cells + width * (yidx > 0 ? yidx - 1 : 0);
+    const char* mid = (const char*)Cells + width * yidx;
+    const char* down = (const char*)Cells + width * (yidx < height - 1 ? yidx + 1 : height - 1);
+    char* out = (char*)nextCells + width * yidx;
+
+    int xidx = UpdateSpanAVX512<Birth, Survival>(up, mid, down, out, 1, width, GetRule());
+    nextCells[width * yidx] = CheckRule(Cells, 0, yidx, width, height);
+    for (; xidx < width; xidx++)
+    {
+        nextCells[xidx + width * yidx] = CheckRule(Cells, xidx, yidx, width, height);
+    }
+}
+
+/*
+Rules in Hensel notation have no count to match, the gather kernels build the 9-bit index of the 512 table
+for 16 cells at a time, bit (3 * column + row) as in LifeTable.h, and look the next states up with gathers.
+*/
+TARGET_AVX2 static inline __m256i IndexBitsAVX2(const char* row, int shift)
+{
+    return _mm256_slli_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)row)), shift);
+}
+
+TARGET_AVX2 static void UpdateRowGatherAVX2(const bool* Cells, bool* nextCells, int yidx, int width, int height)
+{
+    const char* up = (const char*)Cells + width * (yidx > 0 ? yidx - 1 : 0);
+    const char* mid = (const char*)Cells + width * yidx;
+    const char* down = (const char*)Cells + width * (yidx < height - 1 ? yidx + 1 : height - 1);
+    char* out = (char*)nextCells + width * yidx;
+
+    int xidx = 1;
+    for (; xidx < width - 1 && width >= 18; xidx += 16)
+    {
+        // The last vector overlaps the one before and ends at width - 2
+        if (xidx + 16 >= width)
+            xidx = width - 17;
+        __m256i index = _mm256_or_si256(_mm256_or_si256(
+            _mm256_or_si256(IndexBitsAVX2(up + xidx - 1, 0), IndexBitsAVX2(mid + xidx - 1, 1)),
+            _mm256_or_si256(IndexBitsAVX2(down + xidx - 1, 2), IndexBitsAVX2(up + xidx, 3))),
+            _mm256_or_si256(_mm256_or_si256(IndexBitsAVX2(mid + xidx, 4), IndexBitsAVX2(down + xidx, 5)),
+            _mm256_or_si256(_mm256_or_si256(IndexBitsAVX2(up + xidx + 1, 6), IndexBitsAVX2(mid + xidx + 1, 7)),
+            IndexBitsAVX2(down + xidx + 1, 8))));
+
+        __m256i lo = _mm256_i32gather_epi32(GatherTable512, _mm256_cvtepu16_epi32(_mm256_castsi256_si128(index)), 4);
+        __m256i hi = _mm256_i32gather_epi32(GatherTable512, _mm256_cvtepu16_epi32(_mm256_extracti128_si256(index, 1)), 4);
+        // packus interleaves the 128-bit lanes, the permute puts cells 0-7 before 8-15 again
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(lo, hi), 0xD8);
+        __m128i live = _mm_packus_epi16(_mm256_castsi256_si128(packed), _mm256_extracti128_si256(packed, 1));
+        _mm_storeu_si128((__m128i*)(out + xidx), live);
+    }
+
+    nextCells[width * yidx] = CheckRule(Cells, 0, yidx, width, height);
+    for (; xidx < width; xidx++)
+    {
+        nextCells[xidx + width * yidx] = CheckRule(Cells, xidx, yidx, width, height);
+    }
+}
+
+TARGET_AVX512 static inline __m512i IndexBitsAVX512(const char* row, int shift)
+{
+    return _mm512_slli_epi32(_mm512_cvtepu8_epi32(_mm_loadu_si128((const __m128i*)row)), shift);
+}
+
+TARGET_AVX512 static void UpdateRowGatherAVX512(const bool* Cells, bool* nextCells, int yidx, int width, int height)
+{
+    const char* up = (const char*)Cells + width * (yidx > 0 ? yidx - 1 : 0);
+    const char* mid = (const char*)Cells + width * yidx;
+    const char* down = (const char*)Cells + width * (yidx < height - 1 ? yidx + 1 : height - 1);
+    char* out = (char*)nextCells + width * yidx;
+
+    int xidx = 1;
+    for (; xidx < width - 1 && width >= 18; xidx += 16)
+    {
+        // The last vector overlaps the one before and ends at width - 2
+        if (xidx + 16 >= width)
+            xidx = width - 17;
+        __m512i index = _mm512_or_si512(_mm512_or_si512(
+            _mm512_or_si512(IndexBitsAVX512(up + xidx - 1, 0), IndexBitsAVX512(mid + xidx - 1, 1)),
+            _mm512_or_si512(IndexBitsAVX512(down + xidx - 1, 2), IndexBitsAVX512(up + xidx, 3))),
+            _mm512_or_si512(_mm512_or_si512(IndexBitsAVX512(mid + xidx, 4), IndexBitsAVX512(down + xidx, 5)),
+            _mm512_or_si512(_mm512_or_si512(IndexBitsAVX512(up + xidx + 1, 6), IndexBitsAVX512(mid + xidx + 1, 7)),
+            IndexBitsAVX512(down + xidx + 1, 8))));
+
+        __m512i live = _mm512_i32gather_epi32(index, GatherTable512, 4);
+        _mm_storeu_si128((__m128i*)(out + xidx), _mm512_cvtepi32_epi8(live));
+    }
+
+    nextCells[width * yidx] = CheckRule(Cells, 0, yidx, width, height);
+    for (; xidx < width; xidx++)
+    {
+        nextCells[xidx + width * yidx] = CheckRule(Cells, xidx, yidx, width, height);
+    }
+}
+
+#endif
+
+// One row kernel per cell kernel and rule kernel, NULL where the CPU family has no such kernel
+static const CellRowKernel RowKernels[NUM_CELL_KERNELS][NUM_RULE_KERNELS] =
+{
+    { UpdateRows<UpdateRowScalar>, UpdateRows<UpdateRowScalar>, UpdateRows<UpdateRowScalar>, UpdateRows<UpdateRowScalar> },
+    { UpdateRows<UpdateRowLUT512>, UpdateRows<UpdateRowLUT512>, UpdateRows<UpdateRowLUT512>, UpdateRows<UpdateRowLUT512> },
+    { UpdateRowsLUT4x4, UpdateRowsLUT4x4, UpdateRowsLUT4x4, UpdateRowsLUT4x4 },
+#if CELL_KERNEL_X86
+    {
+        UpdateRows<UpdateRowSSE2<RULE_RUNTIME, RULE_RUNTIME>>,
+        UpdateRows<UpdateRowSSE2<RULE_B3, RULE_S23>>,
+        UpdateRows<UpdateRowSSE2<RULE_B36, RULE_S23>>,
+        UpdateRows<UpdateRowSSE2<RULE_B3678, RULE_S34678>>,
+    },
+    {
+        UpdateRows<UpdateRowAVX2<RULE_RUNTIME, RULE_RUNTIME>>,
+        UpdateRows<UpdateRowAVX2<RULE_B3, RULE_S23>>,
+        UpdateRows<UpdateRowAVX2<RULE_B36, RULE_S23>>,
+        UpdateRows<UpdateRowAVX2<RULE_B3678, RULE_S34678>>,
+    },
+    {
+        UpdateRows<UpdateRowAVX512<RULE_RUNTIME, RULE_RUNTIME>>,
+        UpdateRows<UpdateRowAVX512<RULE_B3, RULE_S23>>,
+        UpdateRows<UpdateRowAVX512<RULE_B36, RULE_S23>>,
+        UpdateRows<UpdateRowAVX512<RULE_B3678, RULE_S34678>>,
+    },
+#endif
+};
+
+// Rules in Hensel notation : the table kernels look up any rule already, SSE2 has no gather
+static const CellRowKernel IsotropicRowKernels[NUM_CELL_KERNELS] =
+{
+    UpdateRows<UpdateRowScalar>,
+    UpdateRows<UpdateRowLUT512>,
+    UpdateRowsLUT4x4,
+#if CELL_KERNEL_X86
+    NULL,
+    UpdateRows<UpdateRowGatherAVX2>,
+    UpdateRows<UpdateRowGatherAVX512>,
+#endif
+};
+
+static CellKernelType CurrentKernel = CELL_KERNEL_SCALAR;
+static CellRowKernel CurrentRowKernel = UpdateRows<UpdateRowScalar>;
+
+// Picks the kernel specialized on the current rule, so it has to follow SetRule.
+// Von Neumann and hexagonal rules only run the scalar kernel, CheckRule counts their neighbours
+bool SetCellKernel(CellKernelType type)
+{
+    Rule rule = GetRule();
+    if (type < 0 || type >= NUM_CELL_KERNELS || RowKernels[type][0] == NULL ||
+        (rule.isIsotropic && IsotropicRowKernels[type] == NULL) ||
+        (rule.neighbourhood != NEIGHBOURHOOD_MOORE && type != CELL_KERNEL_SCALAR))
+    {
+        printf("SetCellKernel %s not available\n", GetCellKernelName(type));
+        return false;
+    }
+
+    if (rule.isIsotropic)
+    {
+        for (int index = 0; index < 512; index++)
+        {
+            RuleTable512.Next[index] = IsNextLive512(rule, index);
+            GatherTable512[index] = RuleTable512.Next[index];
+        }
+        RuleTable4x4 = LifeTable4x4(RuleTable512);
+        Table512 = &RuleTable512;
+        Table4x4 = &RuleTable4x4;
+        CurrentRowKernel = IsotropicRowKernels[type];
+        CurrentKernel = type;
+        return true;
+    }
+    if (GetRuleKernel() == RULE_KERNEL_LIFE)
+    {
+        Table512 = &LifeTable512Life;
+        Table4x4 = &LifeTable4x4Life;
+    }
+    else if (type == CELL_KERNEL_LUT512 || type == CELL_KERNEL_LUT4X4)
+    {
+        RuleTable512 = LifeTable512(rule.birth, rule.survival);
+        RuleTable4x4 = LifeTable4x4(rule.birth, rule.survival);
+        Table512 = &RuleTable512;
+        Table4x4 = &RuleTable4x4;
+    }
+
+    CurrentRowKernel = RowKernels[type][GetRuleKernel()];
+    CurrentKernel = type;
+    return true;
+}
+
+CellKernelType GetCellKernel()
+{
+    return CurrentKernel;
+}
+
+const char* GetCellKernelName(CellKernelType type)
+{
+    switch (type)
+    {
+    case CELL_KERNEL_SCALAR:
+        return "Scalar";
+    case CELL_KERNEL_LUT512:
+        return "LUT 512";
+    case CELL_KERNEL_LUT4X4:
+        return "LUT 4x4";
+    case CELL_KERNEL_SSE2:
+        return "SSE2";
+    case CELL_KERNEL_AVX2:
+        return "AVX2";
+    case CELL_KERNEL_AVX512:
+        return "AVX-512F";
+    default:
+        return "Unknown";
+    }
+}
+
+void UpdateCellRows(const bool* Cells, bool* nextCells, int yBegin, int yEnd, int width, int height)
+{
+    CurrentRowKernel(Cells, nextCells, yBegin, yEnd, width, height);
+}
+
+/*
+CPUID : the instruction set and the OS saving its registers (XCR0), AVX2 needs the YMM state,
+AVX-512F also the opmask and ZMM states.
+*/
+static bool HasCpuKernel(CellKernelType type)
+{
+#if CELL_KERNEL_X86 && defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 1);
+    bool hasSSE2 = (info[3] >> 26) & 1;
+    unsigned long long xcr0 = ((info[2] >> 27) & 1) ? _xgetbv(0) : 0;
+    __cpuidex(info, 7, 0);
+    switch (type)
+    {
+    case CELL_KERNEL_SSE2:
+        return hasSSE2;
+    case CELL_KERNEL_AVX2:
+        return ((info[1] >> 5) & 1) && (xcr0 & 0x6) == 0x6;
+    case CELL_KERNEL_AVX512:
+        return ((info[1] >> 16) & 1) && (xcr0 & 0xE6) == 0xE6;
+    default:
+        return true;
+    }
+#elif CELL_KERNEL_X86
+    __builtin_cpu_init();
+    switch (type)
+    {
+    case CELL_KERNEL_SSE2:
+        return __builtin_cpu_supports("sse2");
+    case CELL_KERNEL_AVX2:
+        return __builtin_cpu_supports("avx2");
+    case CELL_KERNEL_AVX512:
+        return __builtin_cpu_supports("avx512f");
+    default:
+        return true;
+    }
+#else
+    return type < CELL_KERNEL_SSE2;
+#endif
+}
+
+// Widest SIMD kernel this CPU runs, checked once at startup, the 4x4 table kernel without SIMD
+CellKernelType DetectCellKernel()
+{
+    if (HasCpuKernel(CELL_KERNEL_AVX512))
+        return CELL_KERNEL_AVX512;
+    if (HasCpuKernel(CELL_KERNEL_AVX2))
+        return CELL_KERNEL_AVX2;
+    if (HasCpuKernel(CELL_KERNEL_SSE2))
+        return CELL_KERNEL_SSE2;
+    return CELL_KERNEL_LUT4X4;
+}
+
+void SelectCellKernel()
+{
+    CellKernelType type = DetectCellKernel();
+    while (SetCellKernel(type) != true && type != CELL_KERNEL_SCALAR)
+        type = (CellKernelType)(type - 1);
+    printf("Cell Kernel : %s\n", GetCellKernelName(GetCellKernel()));
+}
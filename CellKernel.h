@@ -0,0 +1,28 @@
+#pragma once
+
+/*
+Row kernels for the bool* Cells grid used by UpdateCell.
+All kernels give the same result as CheckRule; the table kernels look up one cell per 3x3 neighbourhood
+(512 entries) or a 2x2 block per 4x4 block (65536 entries), the SIMD ones run the interior of a row
+16 (SSE2), 32 (AVX2) or 64 (AVX-512F) cells per instruction and fall back to CheckRule at the edges.
+*/
+enum CellKernelType
+{
+    CELL_KERNEL_SCALAR,
+    CELL_KERNEL_LUT512,
+    CELL_KERNEL_LUT4X4,
+    CELL_KERNEL_SSE2,
+    CELL_KERNEL_AVX2,
+    CELL_KERNEL_AVX512,
+    NUM_CELL_KERNELS
+};
+
+// Updates rows [yBegin, yEnd)
+typedef void (*CellRowKernel)(const bool* Cells, bool* nextCells, int yBegin, int yEnd, int width, int height);
+
+bool SetCellKernel(CellKernelType type);
+CellKernelType GetCellKernel();
+const char* GetCellKernelName(CellKernelType type);
+void UpdateCellRows(const bool* Cells, bool* nextCells, int yBegin, int yEnd, int width, int height);
+CellKernelType DetectCellKernel();
+void SelectCellKernel();
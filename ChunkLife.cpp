@@ -0,0 +1,440 @@
+#include "ChunkLife.h"
+#include "BitSlice.h"
+#include "Memory.h"
+#include "Rule.h"
+#include <stdio.h>
+#include <string.h>
+
+#define CHUNK_MIN_BLOCKS 16
+
+static inline size_t HashChunk(int cx, int cy)
+{
+    uint64_t h = ((uint64_t)(uint32_t)cx << 32 | (uint32_t)cy) * 0x9E3779B97F4A7C15ULL;
+    return (size_t)(h ^ (h >> 29));
+}
+
+bool InitChunkLife(ChunkLife* cl, int numXCells, int numYCells)
+{
+    memset(cl, 0, sizeof(ChunkLife));
+    cl->numXCells = numXCells;
+    cl->numYCells = numYCells;
+    cl->tableSize = CHUNK_MIN_TABLE;
+    cl->maxChunks = CHUNK_MIN_TABLE / 2;
+    cl->maxBlocks = CHUNK_MIN_BLOCKS;
+
+    cl->Table = (LifeChunk**)LifeAlloc(cl->tableSize * sizeof(LifeChunk*));
+    cl->Chunks = (LifeChunk**)LifeAlloc(cl->maxChunks * sizeof(LifeChunk*));
+    cl->ActiveChunks = (LifeChunk**)LifeAlloc(cl->maxChunks * sizeof(LifeChunk*));
+    cl->Blocks = (LifeChunk**)LifeAlloc(cl->maxBlocks * sizeof(LifeChunk*));
+    if (cl->Table == NULL || cl->Chunks == NULL || cl->ActiveChunks == NULL || cl->Blocks == NULL)
+    {
+        printf("ChunkLife LifeAlloc fail\n");
+        FreeChunkLife(cl);
+        return false;
+    }
+    memset(cl->Table, 0, cl->tableSize * sizeof(LifeChunk*));
+
+    return true;
+}
+
+void FreeChunkLife(ChunkLife* cl)
+{
+    for (int idx = 0; idx < cl->numBlocks; idx++)
+        LifeFree(cl->Blocks[idx]);
+    LifeFree(cl->Blocks);
+    LifeFree(cl->Table);
+    LifeFree(cl->Chunks);
+    LifeFree(cl->ActiveChunks);
+    cl->Blocks = NULL;
+    cl->Table = NULL;
+    cl->Chunks = NULL;
+    cl->ActiveChunks = NULL;
+    cl->freeChunks = NULL;
+    cl->numBlocks = 0;
+    cl->numChunks = 0;
+}
+
+// Pool : chunks come from blocks of CHUNK_POOL_BLOCK and go back to the free list, blocks are kept until FreeChunkLife
+static LifeChunk* AllocChunk(ChunkLife* cl)
+{
+    if (cl->freeChunks == NULL)
+    {
+        if (cl->numBlocks == cl->maxBlocks)
+        {
+            int maxBlocks = cl->maxBlocks * 2;
+            LifeChunk** Blocks = (LifeChunk**)LifeAlloc(maxBlocks * sizeof(LifeChunk*));
+            if (Blocks == NULL)
+                return NULL;
+            memcpy(Blocks, cl->Blocks, cl->numBlocks * sizeof(LifeChunk*));
+            LifeFree(cl->Blocks);
+            cl->Blocks = Blocks;
+            cl->maxBlocks = maxBlocks;
+        }
+
+        LifeChunk* block = (LifeChunk*)LifeAlloc(CHUNK_POOL_BLOCK * sizeof(LifeChunk));
+        if (block == NULL)
+            return NULL;
+        cl->Blocks[cl->numBlocks++] = block;
+        for (int i = CHUNK_POOL_BLOCK - 1; i >= 0; i--)
+        {
+            block[i].nextFree = cl->freeChunks;
+            cl->freeChunks = &block[i];
+        }
+    }
+
+    LifeChunk* chunk = cl->freeChunks;
+    cl->freeChunks = chunk->nextFree;
+    return chunk;
+}
+
+static LifeChunk* FindChunk(const ChunkLife* cl, int cx, int cy)
+{
+    size_t mask = cl->tableSize - 1;
+    for (size_t slot = HashChunk(cx, cy) & mask; cl->Table[slot] != NULL; slot = (slot + 1) & mask)
+    {
+        if (cl->Table[slot]->cx == cx && cl->Table[slot]->cy == cy)
+            return cl->Table[slot];
+    }
+    return NULL;
+}
+
+static void InsertChunk(ChunkLife* cl, LifeChunk* chunk)
+{
+    size_t mask = cl->tableSize - 1;
+    size_t slot = HashChunk(chunk->cx, chunk->cy) & mask;
+    while (cl->Table[slot] != NULL)
+        slot = (slot + 1) & mask;
+    cl->Table[slot] = chunk;
+}
+
+// Backward shift deletion : the chunks after the hole that may live there move up, so probes need no tombstones
+static void RemoveChunk(ChunkLife* cl, const LifeChunk* chunk)
+{
+    size_t mask = cl->tableSize - 1;
+    size_t hole = HashChunk(chunk->cx, chunk->cy) & mask;
+    while (cl->Table[hole] != chunk)
+        hole = (hole + 1) & mask;
+    cl->Table[hole] = NULL;
+
+    for (size_t slot = (hole + 1) & mask; cl->Table[slot] != NULL; slot = (slot + 1) & mask)
+    {
+        size_t home = HashChunk(cl->Table[slot]->cx, cl->Table[slot]->cy) & mask;
+        if (((slot - home) & mask) >= ((slot - hole) & mask))
+        {
+            cl->Table[hole] = cl->Table[slot];
+            cl->Table[slot] = NULL;
+            hole = slot;
+        }
+    }
+}
+
+// The table stays at most half full, Chunks and ActiveChunks hold up to half the table
+static bool GrowChunkLife(ChunkLife* cl)
+{
+    size_t tableSize = cl->tableSize * 2;
+    int maxChunks = (int)(tableSize / 2);
+    LifeChunk** Table = (LifeChunk**)LifeAlloc(tableSize * sizeof(LifeChunk*));
+    LifeChunk** Chunks = (LifeChunk**)LifeAlloc(maxChunks * sizeof(LifeChunk*));
+    LifeChunk** ActiveChunks = (LifeChunk**)LifeAlloc(maxChunks * sizeof(LifeChunk*));
+    if (Table == NULL || Chunks == NULL || ActiveChunks == NULL)
+    {
+        printf("GrowChunkLife fail\n");
+        LifeFree(Table);
+        LifeFree(Chunks);
+        LifeFree(ActiveChunks);
+        return false;
+    }
+    memset(Table, 0, tableSize * sizeof(LifeChunk*));
+    memcpy(Chunks, cl->Chunks, cl->numChunks * sizeof(LifeChunk*));
+
+    LifeFree(cl->Table);
+    LifeFree(cl->Chunks);
+    LifeFree(cl->ActiveChunks);
+    cl->Table = Table;
+    cl->tableSize = tableSize;
+    cl->Chunks = Chunks;
+    cl->ActiveChunks = ActiveChunks;
+    cl->maxChunks = maxChunks;
+    for (int idx = 0; idx < cl->numChunks; idx++)
+        InsertChunk(cl, cl->Chunks[idx]);
+    return true;
+}
+
+// Empty chunk at (cx, cy), linked to the allocated chunks around it
+static LifeChunk* CreateChunk(ChunkLife* cl, int cx, int cy)
+{
+    if (cl->numChunks == cl->maxChunks && GrowChunkLife(cl) != true)
+        return NULL;
+    LifeChunk* chunk = AllocChunk(cl);
+    if (chunk == NULL)
+    {
+        printf("ChunkLife chunk alloc fail\n");
+        return NULL;
+    }
+
+    memset(chunk->Rows, 0, sizeof(chunk->Rows));
+    chunk->cx = cx;
+    chunk->cy = cy;
+    chunk->changed = CHANGED_1 | CHANGED_2;
+    chunk->nextChanged = 0;
+    chunk->IsEmpty[0] = true;
+    chunk->IsEmpty[1] = true;
+    chunk->isNeeded = false;
+    for (int dir = 0; dir < 9; dir++)
+    {
+        LifeChunk* neighbour = dir == 4 ? chunk : FindChunk(cl, cx + dir % 3 - 1, cy + dir / 3 - 1);
+        chunk->Neighbours[dir] = neighbour;
+        if (neighbour != NULL)
+            neighbour->Neighbours[8 - dir] = chunk;
+    }
+
+    InsertChunk(cl, chunk);
+    chunk->listIdx = cl->numChunks;
+    cl->Chunks[cl->numChunks++] = chunk;
+    return chunk;
+}
+
+static void ReleaseChunk(ChunkLife* cl, LifeChunk* chunk)
+{
+    for (int dir = 0; dir < 9; dir++)
+    {
+        if (dir != 4 && chunk->Neighbours[dir] != NULL)
+            chunk->Neighbours[dir]->Neighbours[8 - dir] = NULL;
+    }
+    RemoveChunk(cl, chunk);
+
+    LifeChunk* last = cl->Chunks[--cl->numChunks];
+    cl->Chunks[chunk->listIdx] = last;
+    last->listIdx = chunk->listIdx;
+
+    chunk->nextFree = cl->freeChunks;
+    cl->freeChunks = chunk;
+}
+
+/*
+Creates the neighbours that live cells on an edge or corner of a chunk touch, so births next to
+the chunk have somewhere to go, and marks them needed.
+*/
+static bool AddEdgeChunks(ChunkLife* cl)
+{
+    int numChunks = cl->numChunks;
+    for (int idx = 0; idx < numChunks; idx++)
+    {
+        LifeChunk* chunk = cl->Chunks[idx];
+        if (chunk->IsEmpty[cl->parity])
+            continue;
+
+        const uint64_t* Rows = chunk->Rows[cl->parity];
+        uint64_t live = 0;
+        for (int yidx = 0; yidx < CHUNK_SIZE; yidx++)
+            live |= Rows[yidx];
+        uint64_t top = Rows[0];
+        uint64_t bottom = Rows[CHUNK_SIZE - 1];
+        bool isTouched[9] = { (top & 1) != 0, top != 0, (top >> 63) != 0,
+                              (live & 1) != 0, false, (live >> 63) != 0,
+                              (bottom & 1) != 0, bottom != 0, (bottom >> 63) != 0 };
+
+        for (int dir = 0; dir < 9; dir++)
+        {
+            if (isTouched[dir] != true)
+                continue;
+            LifeChunk* neighbour = chunk->Neighbours[dir];
+            if (neighbour == NULL)
+                neighbour = CreateChunk(cl, chunk->cx + dir % 3 - 1, chunk->cy + dir / 3 - 1);
+            if (neighbour == NULL)
+                return false;
+            neighbour->isNeeded = true;
+        }
+    }
+    return true;
+}
+
+// Rows -1 .. CHUNK_SIZE of one column of chunks, zero where no chunk is allocated
+static void GetColumnRows(const LifeChunk* up, const LifeChunk* mid, const LifeChunk* down, int parity, uint64_t* Column)
+{
+    Column[0] = up != NULL ? up->Rows[parity][CHUNK_SIZE - 1] : 0;
+    if (mid != NULL)
+        memcpy(Column + 1, mid->Rows[parity], CHUNK_SIZE * sizeof(uint64_t));
+    else
+        memset(Column + 1, 0, CHUNK_SIZE * sizeof(uint64_t));
+    Column[CHUNK_SIZE + 1] = down != NULL ? down->Rows[parity][0] : 0;
+}
+
+/*
+Next generation of one chunk into Rows[parity ^ 1], which holds generation t-1 until it is overwritten.
+Only bit 63 of the West column and bit 0 of the East column reach the chunk through the shifts.
+*/
+template <int Birth, int Survival>
+static void UpdateChunk(const ChunkLife* cl, LifeChunk* chunk)
+{
+    Rule rule = GetRule();
+    int parity = cl->parity;
+    LifeChunk* const* Nb = chunk->Neighbours;
+    uint64_t W[CHUNK_SIZE + 2], M[CHUNK_SIZE + 2], E[CHUNK_SIZE + 2];
+    GetColumnRows(Nb[0], Nb[3], Nb[6], parity, W);
+    GetColumnRows(Nb[1], Nb[4], Nb[7], parity, M);
+    GetColumnRows(Nb[2], Nb[5], Nb[8], parity, E);
+
+    uint64_t* Next = chunk->Rows[parity ^ 1];
+    uint64_t diff1 = 0, diff2 = 0, live = 0;
+    for (int yidx = 0; yidx < CHUNK_SIZE; yidx++)
+    {
+        uint64_t next = LifeWord<Birth, Survival>(West(M[yidx], W[yidx]), M[yidx], East(M[yidx], E[yidx]),
+                                                  West(M[yidx + 1], W[yidx + 1]), M[yidx + 1], East(M[yidx + 1], E[yidx + 1]),
+                                                  West(M[yidx + 2], W[yidx + 2]), M[yidx + 2], East(M[yidx + 2], E[yidx + 2]), rule);
+        diff1 |= next ^ M[yidx + 1];
+        diff2 |= next ^ Next[yidx];
+        live |= next;
+        Next[yidx] = next;
+    }
+
+    // An edited chunk no longer follows from generation t-1, it stays out of the period 2 skip once more
+    chunk->nextChanged = (diff1 != 0 ? CHANGED_1 : 0) | (diff2 != 0 || (chunk->changed & CHANGED_EDIT) ? CHANGED_2 : 0);
+    chunk->IsEmpty[parity ^ 1] = live == 0;
+}
+
+typedef void (*ChunkKernel)(const ChunkLife* cl, LifeChunk* chunk);
+
+static const ChunkKernel ChunkKernels[NUM_RULE_KERNELS] =
+{
+    UpdateChunk<RULE_RUNTIME, RULE_RUNTIME>,
+    UpdateChunk<RULE_B3, RULE_S23>,
+    UpdateChunk<RULE_B36, RULE_S23>,
+    UpdateChunk<RULE_B3678, RULE_S34678>,
+};
+
+static void UpdateChunkTask(void* context, int taskIdx, int threadIdx)
+{
+    const ChunkLife* cl = (const ChunkLife*)context;
+    ChunkKernels[GetRuleKernel()](cl, cl->ActiveChunks[taskIdx]);
+}
+
+/*
+Returns the chunks that stayed empty and untouched to the pool and collects the chunks to compute :
+some chunk of the 3x3 neighbourhood changed since t-1 and some since t-2. A released chunk was empty in
+generations t-2 .. t, so its neighbours see no change where it was. A skipped chunk keeps Rows[parity ^ 1],
+which is generation t+1, so it differs from t where it differed from t-1 and no longer differs from t-1.
+*/
+static int CollectActiveChunks(ChunkLife* cl)
+{
+    int numActive = 0;
+    for (int idx = cl->numChunks - 1; idx >= 0; idx--)
+    {
+        LifeChunk* chunk = cl->Chunks[idx];
+        bool isNeeded = chunk->isNeeded;
+        chunk->isNeeded = false;
+        if (chunk->IsEmpty[cl->parity] && chunk->changed == 0 && isNeeded != true)
+        {
+            ReleaseChunk(cl, chunk);
+            continue;
+        }
+
+        int changed = 0;
+        for (int dir = 0; dir < 9; dir++)
+            changed |= chunk->Neighbours[dir] != NULL ? chunk->Neighbours[dir]->changed : 0;
+        if ((changed & (CHANGED_1 | CHANGED_2)) == (CHANGED_1 | CHANGED_2))
+            cl->ActiveChunks[numActive++] = chunk;
+        else
+            chunk->nextChanged = chunk->changed & CHANGED_1;
+    }
+    return numActive;
+}
+
+bool UpdateChunkLife(ChunkLife* cl, ThreadPool* pool)
+{
+    if (cl->Table == NULL || AddEdgeChunks(cl) != true)
+    {
+        printf("UpdateChunkLife fail\n");
+        return false;
+    }
+
+    cl->numActiveChunks = CollectActiveChunks(cl);
+    if (pool != NULL && pool->numThreads > 1)
+    {
+        RunThreadPoolStealing(pool, UpdateChunkTask, cl, cl->numActiveChunks);
+    }
+    else
+    {
+        for (int taskIdx = 0; taskIdx < cl->numActiveChunks; taskIdx++)
+            UpdateChunkTask(cl, taskIdx, 0);
+    }
+
+    cl->parity ^= 1;
+    for (int idx = 0; idx < cl->numChunks; idx++)
+        cl->Chunks[idx]->changed = cl->Chunks[idx]->nextChanged;
+
+    return true;
+}
+
+// Every chunk back to the pool
+static void ClearChunkLife(ChunkLife* cl)
+{
+    for (int idx = 0; idx < cl->numChunks; idx++)
+    {
+        cl->Chunks[idx]->nextFree = cl->freeChunks;
+        cl->freeChunks = cl->Chunks[idx];
+    }
+    cl->numChunks = 0;
+    memset(cl->Table, 0, cl->tableSize * sizeof(LifeChunk*));
+}
+
+// Replaces the plane with the window, the chunks of the window with live cells are created
+void LoadChunkLife(ChunkLife* cl, const bool* Cells)
+{
+    int numXCells = cl->numXCells;
+    int numYCells = cl->numYCells;
+
+    ClearChunkLife(cl);
+    for (int cy = 0; cy * CHUNK_SIZE < numYCells; cy++)
+    {
+        for (int cx = 0; cx * CHUNK_SIZE < numXCells; cx++)
+        {
+            uint64_t Rows[CHUNK_SIZE] = {};
+            uint64_t live = 0;
+            for (int yidx = 0; yidx < CHUNK_SIZE && cy * CHUNK_SIZE + yidx < numYCells; yidx++)
+            {
+                const bool* src = Cells + (size_t)numXCells * (cy * CHUNK_SIZE + yidx) + cx * CHUNK_SIZE;
+                for (int xidx = 0; xidx < CHUNK_SIZE && cx * CHUNK_SIZE + xidx < numXCells; xidx++)
+                    Rows[yidx] |= (uint64_t)src[xidx] << xidx;
+                live |= Rows[yidx];
+            }
+            if (live == 0)
+                continue;
+
+            LifeChunk* chunk = CreateChunk(cl, cx, cy);
+            if (chunk == NULL)
+            {
+                printf("LoadChunkLife fail\n");
+                return;
+            }
+            memcpy(chunk->Rows[cl->parity], Rows, sizeof(Rows));
+            chunk->IsEmpty[cl->parity] = false;
+            chunk->changed = CHANGED_1 | CHANGED_2 | CHANGED_EDIT;
+        }
+    }
+}
+
+// The window of the plane, chunks outside it are skipped
+void StoreChunkLife(const ChunkLife* cl, bool* Cells)
+{
+    int numXCells = cl->numXCells;
+    int numYCells = cl->numYCells;
+
+    memset(Cells, 0, (size_t)numXCells * numYCells * sizeof(bool));
+    for (int idx = 0; idx < cl->numChunks; idx++)
+    {
+        const LifeChunk* chunk = cl->Chunks[idx];
+        int64_t x0 = (int64_t)chunk->cx * CHUNK_SIZE;
+        int64_t y0 = (int64_t)chunk->cy * CHUNK_SIZE;
+        if (chunk->IsEmpty[cl->parity] || x0 < 0 || y0 < 0 || x0 >= numXCells || y0 >= numYCells)
+            continue;
+
+        uint64_t mask = x0 + CHUNK_SIZE <= numXCells ? ~0ULL : (1ULL << (numXCells - x0)) - 1;
+        for (int yidx = 0; yidx < CHUNK_SIZE && y0 + yidx < numYCells; yidx++)
+        {
+            bool* dst = Cells + (size_t)numXCells * (y0 + yidx) + x0;
+            for (uint64_t word = chunk->Rows[cl->parity][yidx] & mask; word != 0; word &= word - 1)
+                dst[LowestBit(word)] = true;
+        }
+    }
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "ThreadPool.h"
+#include "BitBoard.h"
+
+#define CHUNK_LOG2 6
+#define CHUNK_SIZE (1 << CHUNK_LOG2)    // a chunk is CHUNK_SIZE x CHUNK_SIZE cells, one word per row
+#define CHUNK_POOL_BLOCK 256            // chunks per pool block
+#define CHUNK_MIN_TABLE 4096
+
+/*
+One chunk of the plane, cells (cx * CHUNK_SIZE + x, cy * CHUNK_SIZE + y) for x, y in 0 .. CHUNK_SIZE - 1,
+bit x of row y. Rows[parity] holds the current generation and Rows[parity ^ 1] receives the next one.
+Neighbours are linked when a chunk is created, so a generation needs no hash lookups.
+*/
+struct alignas(64) LifeChunk
+{
+    uint64_t Rows[2][CHUNK_SIZE];
+    LifeChunk* Neighbours[9];   // (dx + 1) + 3 * (dy + 1), NULL where no chunk is allocated, [4] is the chunk itself
+    LifeChunk* nextFree;        // pool free list
+    int cx;
+    int cy;
+    int listIdx;                // index in Chunks
+    uint8_t changed;            // CHANGED_1 / CHANGED_2 : current generation differs from generation t-1 / t-2, CHANGED_EDIT
+    uint8_t nextChanged;
+    bool IsEmpty[2];            // no live cell in Rows[0] / Rows[1]
+    bool isNeeded;              // a live cell of a neighbour touches the chunk
+};
+
+/*
+Unbounded plane of bit-packed chunks : only chunks around live cells are allocated, they are found by
+chunk coordinate in an open addressing hash table and stored in blocks of CHUNK_POOL_BLOCK chunks.
+Before every generation the chunks with live cells on an edge or corner get the neighbours they touch,
+and the chunks that stayed empty for three generations and touch no live cell go back to the pool,
+so memory and the cost of a generation follow the occupied area.
+Activity tracking as in the BitBoard : a chunk whose 3x3 neighbourhood is unchanged since generation t-1
+or t-2 repeats generation t-1, which Rows[parity ^ 1] still holds, so it is skipped.
+The bool grid is a window onto the plane : cell (x, y) of the grid is plane cell (x, y).
+*/
+struct ChunkLife
+{
+    int numXCells;
+    int numYCells;
+    int parity;                 // Rows[parity] of every chunk is the current generation
+    LifeChunk** Table;          // open addressing, linear probing, tableSize a power of 2
+    size_t tableSize;
+    LifeChunk** Chunks;         // allocated chunks
+    int numChunks;
+    int maxChunks;              // capacity of Chunks and ActiveChunks
+    LifeChunk** ActiveChunks;   // chunks to compute this update
+    int numActiveChunks;        // chunks computed in the last update
+    LifeChunk* freeChunks;      // pool free list
+    LifeChunk** Blocks;         // pool blocks
+    int numBlocks;
+    int maxBlocks;
+};
+
+bool InitChunkLife(ChunkLife* cl, int numXCells, int numYCells);
+void FreeChunkLife(ChunkLife* cl);
+bool UpdateChunkLife(ChunkLife* cl, ThreadPool* pool);
+
+void LoadChunkLife(ChunkLife* cl, const bool* Cells);
+void StoreChunkLife(const ChunkLife* cl, bool* Cells);
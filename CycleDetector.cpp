@@ -0,0 +1,234 @@
+#include "CycleDetector.h"
+#include "Memory.h"
+#include <stdio.h>
+#include <string.h>
+
+// SplitMix64 finalizer
+static inline uint64_t Mix(uint64_t z)
+{
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Key of a cell in a non-zero state, a mix of (cell, state) so no table of keys is needed
+static inline uint64_t GetCellKey(int idx, uint8_t state)
+{
+    return state != 0 ? Mix(((uint64_t)idx << 8 | state) * 0x9E3779B97F4A7C15ULL) : 0;
+}
+
+/*
+Key of a word of a BitBoard row, its 64 cells hashed at once. The second half makes the key of a dead word
+0 like the one of a dead cell, it cancels out when a word is rehashed so updates leave it out.
+*/
+static inline uint64_t GetWordKey(uint64_t idx, uint64_t word)
+{
+    uint64_t salt = idx * 0x9E3779B97F4A7C15ULL;
+    return Mix(word ^ salt) ^ Mix(salt);
+}
+
+/*
+Runs that stop at the first repeat need no frames, replays take as many as fit in CYCLE_FRAME_BYTES.
+numCells 0 : the boards come from a BitBoard, nothing is allocated.
+*/
+bool InitCycleDetector(CycleDetector* cycle, int numCells, bool hasFrames)
+{
+    memset(cycle, 0, sizeof(CycleDetector));
+    cycle->numCells = numCells;
+    if (numCells == 0)
+        return true;
+    if (hasFrames)
+        cycle->maxFrames = CYCLE_FRAME_BYTES / numCells < CYCLE_HISTORY ? CYCLE_FRAME_BYTES / numCells : CYCLE_HISTORY;
+    cycle->Last = (uint8_t*)LifeAlloc(numCells);
+    cycle->Frames = cycle->maxFrames > 0 ? (uint8_t*)LifeAlloc((size_t)cycle->maxFrames * numCells) : NULL;
+    if (cycle->Last == NULL || (cycle->maxFrames > 0 && cycle->Frames == NULL))
+    {
+        printf("CycleDetector LifeAlloc fail\n");
+        FreeCycleDetector(cycle);
+        return false;
+    }
+    memset(cycle->Last, 0, numCells);
+    return true;
+}
+
+void FreeCycleDetector(CycleDetector* cycle)
+{
+    LifeFree(cycle->Last);
+    LifeFree(cycle->Frames);
+    cycle->Last = NULL;
+    cycle->Frames = NULL;
+}
+
+static void ForgetCycle(CycleDetector* cycle)
+{
+    cycle->period = 0;
+    cycle->numFrames = 0;
+    cycle->isConfirmed = false;
+}
+
+// Starts over from Board, after edits or a restart
+void ResetCycleDetector(CycleDetector* cycle, const uint8_t* Board)
+{
+    ForgetCycle(cycle);
+    memcpy(cycle->Last, Board, cycle->numCells);
+    cycle->hash = 0;
+    for (int idx = 0; idx < cycle->numCells; idx++)
+        cycle->hash ^= GetCellKey(idx, Board[idx]);
+    cycle->generation = 0;
+    cycle->History[0] = cycle->hash;
+}
+
+// XOR out the old and in the new key of every changed cell, unchanged words cost one compare
+static void UpdateHash(CycleDetector* cycle, const uint8_t* Board)
+{
+    int numCells = cycle->numCells;
+    uint8_t* Last = cycle->Last;
+    uint64_t hash = cycle->hash;
+    int idx = 0;
+    for (; idx + 8 <= numCells; idx += 8)
+    {
+        uint64_t last, next;
+        memcpy(&last, Last + idx, 8);
+        memcpy(&next, Board + idx, 8);
+        if (last == next)
+            continue;
+        for (int byte = idx; byte < idx + 8; byte++)
+        {
+            if (Last[byte] != Board[byte])
+                hash ^= GetCellKey(byte, Last[byte]) ^ GetCellKey(byte, Board[byte]);
+        }
+        memcpy(Last + idx, &next, 8);
+    }
+    for (; idx < numCells; idx++)
+    {
+        if (Last[idx] != Board[idx])
+            hash ^= GetCellKey(idx, Last[idx]) ^ GetCellKey(idx, Board[idx]);
+        Last[idx] = Board[idx];
+    }
+    cycle->hash = hash;
+}
+
+// Frames of the cycle and the hash of the new generation against the last CYCLE_HISTORY ones
+static int FindCycle(CycleDetector* cycle, const uint8_t* Board)
+{
+    uint64_t gen = cycle->generation;
+
+    if (cycle->period > 0 && cycle->isConfirmed != true && cycle->numFrames > 0)
+    {
+        if (cycle->numFrames < cycle->period)
+        {
+            memcpy(cycle->Frames + (size_t)cycle->numFrames * cycle->numCells, Board, cycle->numCells);
+            cycle->numFrames++;
+        }
+        else if (memcmp(Board, cycle->Frames, cycle->numCells) == 0)
+        {
+            cycle->isConfirmed = true;
+        }
+        else
+        {
+            ForgetCycle(cycle);
+        }
+    }
+
+    if (cycle->period == 0)
+    {
+        int maxPeriod = gen < CYCLE_HISTORY ? (int)gen : CYCLE_HISTORY;
+        for (int period = 1; period <= maxPeriod; period++)
+        {
+            if (cycle->History[(gen - period) % CYCLE_HISTORY] == cycle->hash)
+            {
+                cycle->period = period;
+                cycle->cycleStart = gen - period;
+                if (period <= cycle->maxFrames)
+                {
+                    memcpy(cycle->Frames, Board, cycle->numCells);
+                    cycle->numFrames = 1;
+                }
+                break;
+            }
+        }
+    }
+    cycle->History[gen % CYCLE_HISTORY] = cycle->hash;
+
+    return cycle->period;
+}
+
+/*
+Takes the board of the next generation, returns the period once its hash repeats and 0 before.
+Headless runs can stop there, a hash collision is only ruled out once isConfirmed is set.
+*/
+int UpdateCycleDetector(CycleDetector* cycle, const uint8_t* Board)
+{
+    cycle->generation++;
+    UpdateHash(cycle, Board);
+    return FindCycle(cycle, Board);
+}
+
+// Starts over from the generation in Front of the board, regions that are not committed are dead
+void ResetCycleDetectorBitBoard(CycleDetector* cycle, const BitBoard* board)
+{
+    ForgetCycle(cycle);
+    cycle->hash = 0;
+    for (int yidx = 0; yidx < board->numYCells; yidx++)
+    {
+        const uint64_t* row = board->Front + (size_t)board->stride * yidx;
+        for (int widx = 0; widx < board->numWords; widx++)
+        {
+            if (board->isReserved && widx % REGION_WORDS == 0 &&
+                board->IsCommitted[widx / REGION_WORDS + board->numRegionsX * (yidx / TILE_ROWS)] != true)
+            {
+                widx += REGION_WORDS - 1;
+                continue;
+            }
+            cycle->hash ^= GetWordKey((size_t)board->stride * yidx + widx, row[widx]);
+        }
+    }
+    cycle->generation = 0;
+    cycle->History[0] = cycle->hash;
+}
+
+/*
+After UpdateBitBoard, Back holds the generation before the one in Front and CHANGED_1 marks the tiles
+where the two differ, so only the words of those tiles are rehashed : XOR out the key of the word in
+Back and in the one in Front, without a branch as an unchanged word cancels out.
+Rows of tiles without RowChanged are skipped whole, a still board costs one byte per row of tiles.
+*/
+int UpdateCycleDetectorBitBoard(CycleDetector* cycle, const BitBoard* board)
+{
+    cycle->generation++;
+    uint64_t hash = cycle->hash;
+    for (int ty = 0; ty < board->numTilesY; ty++)
+    {
+        if (board->RowChanged[ty] == 0)
+            continue;
+        int yBegin = ty * TILE_ROWS;
+        int yEnd = yBegin + TILE_ROWS < board->numYCells ? yBegin + TILE_ROWS : board->numYCells;
+        for (int tx = 0; tx < board->numTilesX; tx++)
+        {
+            if ((board->Changed[tx + board->numTilesX * ty] & CHANGED_1) == 0)
+                continue;
+            int wBegin = tx * TILE_WORDS;
+            int wEnd = wBegin + TILE_WORDS < board->numWords ? wBegin + TILE_WORDS : board->numWords;
+            for (int yidx = yBegin; yidx < yEnd; yidx++)
+            {
+                const uint64_t* front = board->Front + (size_t)board->stride * yidx;
+                const uint64_t* back = board->Back + (size_t)board->stride * yidx;
+                for (int widx = wBegin; widx < wEnd; widx++)
+                {
+                    uint64_t salt = ((size_t)board->stride * yidx + widx) * 0x9E3779B97F4A7C15ULL;
+                    hash ^= Mix(back[widx] ^ salt) ^ Mix(front[widx] ^ salt);
+                }
+            }
+        }
+    }
+    cycle->hash = hash;
+    return FindCycle(cycle, NULL);
+}
+
+// Board of the next generation of a confirmed cycle, without running the engine
+const uint8_t* ReplayCycle(CycleDetector* cycle)
+{
+    cycle->generation++;
+    int frame = (int)((cycle->generation - cycle->cycleStart) % cycle->period);
+    return cycle->Frames + (size_t)frame * cycle->numCells;
+}
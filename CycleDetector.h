@@ -0,0 +1,43 @@
+#pragma once
+
+#include <stdint.h>
+#include "BitBoard.h"
+
+#define CYCLE_HISTORY 64    // longest period found, hashes of the last CYCLE_HISTORY boards are kept
+#define CYCLE_FRAME_BYTES (64 << 20)    // cap of the captured boards, longer cycles of large boards are found but not replayed
+
+/*
+Finds the board becoming periodic from a 64-bit Zobrist hash of the board : the XOR of a random key
+of every (cell, state) with a non-zero state. Every update compares the new board to the last one
+8 cells at a time and only rehashes the cells of changed words, the hashes of the last CYCLE_HISTORY
+boards are kept in a ring indexed by generation.
+Once a hash repeats at distance period, the next period boards are captured and the cycle is confirmed
+when the board after them is the first one again, after that ReplayCycle plays it back from memory.
+The frames are allocated once by InitCycleDetector, up to CYCLE_HISTORY boards within CYCLE_FRAME_BYTES.
+Boards are byte grids : the bool Cells of the engines or the states of Generations rules.
+BitBoards are hashed a word of 64 cells at a time from the tiles their update changed, without a byte
+grid or frames.
+*/
+struct CycleDetector
+{
+    int numCells;
+    uint64_t hash;
+    uint64_t generation;            // boards seen since the reset, the reset board is generation 0
+    uint8_t* Last;                  // last board, changed words are found against it
+    uint64_t History[CYCLE_HISTORY];
+    int period;                     // 0 until a hash repeats
+    uint64_t cycleStart;            // first generation of the cycle
+    uint8_t* Frames;                // boards of generations cycleStart + period .. cycleStart + 2 * period - 1
+    int maxFrames;                  // boards Frames holds, longer cycles are not captured
+    int numFrames;                  // captured so far
+    bool isConfirmed;               // all frames captured and the board after them was Frames[0]
+};
+
+bool InitCycleDetector(CycleDetector* cycle, int numCells, bool hasFrames);
+void FreeCycleDetector(CycleDetector* cycle);
+void ResetCycleDetector(CycleDetector* cycle, const uint8_t* Board);
+int UpdateCycleDetector(CycleDetector* cycle, const uint8_t* Board);
+const uint8_t* ReplayCycle(CycleDetector* cycle);
+
+void ResetCycleDetectorBitBoard(CycleDetector* cycle, const BitBoard* board);
+int UpdateCycleDetectorBitBoard(CycleDetector* cycle, const BitBoard* board);
@@ -0,0 +1,282 @@
+#include "Generations.h"
+#include "BitSlice.h"
+#include "Memory.h"
+#include <stdio.h>
+#include <string.h>
+
+bool InitGenerations(Generations* gen, int numXCells, int numYCells, int numStates)
+{
+    gen->numXCells = numXCells;
+    gen->numYCells = numYCells;
+    gen->numWords = (numXCells + 63) / 64;
+    gen->stride = (gen->numWords + 7) & ~7;
+    gen->lastMask = (numXCells % 64 == 0) ? ~0ULL : ((1ULL << (numXCells % 64)) - 1);
+    gen->numStates = numStates;
+    gen->numPlanes = 1;
+    while ((1 << gen->numPlanes) < numStates)
+        gen->numPlanes++;
+    if (gen->numPlanes > GENERATIONS_MAX_PLANES)
+    {
+        printf("InitGenerations %d states fail\n", numStates);
+        gen->Front = NULL;
+        gen->Back = NULL;
+        return false;
+    }
+
+    size_t size = (size_t)gen->stride * gen->numPlanes * numYCells * sizeof(uint64_t);
+    gen->Front = (uint64_t*)LifeAlloc(size);
+    gen->Back = (uint64_t*)LifeAlloc(size);
+    if (gen->Front == NULL || gen->Back == NULL)
+    {
+        printf("Generations LifeAlloc fail\n");
+        FreeGenerations(gen);
+        return false;
+    }
+    memset(gen->Front, 0, size);
+    memset(gen->Back, 0, size);
+
+    return true;
+}
+
+void FreeGenerations(Generations* gen)
+{
+    LifeFree(gen->Front);
+    LifeFree(gen->Back);
+    gen->Front = NULL;
+    gen->Back = NULL;
+}
+
+static inline uint64_t* GetRow(uint64_t* Planes, const Generations* gen, int yidx)
+{
+    return Planes + (size_t)gen->stride * gen->numPlanes * yidx;
+}
+
+// Cells in state 1 : plane 0 set and no other plane
+static inline uint64_t LiveWord(const uint64_t* row, int numPlanes, int stride, int widx)
+{
+    uint64_t rest = 0;
+    for (int p = 1; p < numPlanes; p++)
+    {
+        rest |= row[(size_t)stride * p + widx];
+    }
+    return row[widx] & ~rest;
+}
+
+/*
+Next states of 64 cells of the mid row from the life-like result of their live neighbours.
+Live cells that survive stay in state 1, dead cells that are born go to state 1,
+every other non-zero state counts up by one and wraps to 0 at numStates.
+*/
+static inline void UpdateStates(const uint64_t* mid, uint64_t* out, int numPlanes, int numStates, int stride,
+                                int widx, uint64_t live, uint64_t next, uint64_t mask)
+{
+    uint64_t planes[GENERATIONS_MAX_PLANES];
+    uint64_t any = 0;
+    for (int p = 0; p < numPlanes; p++)
+    {
+        planes[p] = mid[(size_t)stride * p + widx];
+        any |= planes[p];
+    }
+
+    uint64_t born = next & ~any;
+    uint64_t carry = any & ~(next & live);
+    uint64_t wrap = carry;
+    for (int p = 0; p < numPlanes; p++)
+    {
+        uint64_t plane = planes[p];
+        planes[p] = plane ^ carry;
+        carry &= plane;
+        wrap &= ((numStates >> p) & 1) ? planes[p] : ~planes[p];
+    }
+    // A power of two number of states wraps by the dropped carry, anything else is cleared at numStates
+    if ((1 << numPlanes) == numStates)
+        wrap = 0;
+
+    planes[0] |= born;
+    for (int p = 0; p < numPlanes; p++)
+    {
+        out[(size_t)stride * p + widx] = planes[p] & ~wrap & mask;
+    }
+}
+
+// Window Boundary Rule : same clamping as the BitBoard UpdateRow, on the live plane
+static void UpdateGenerationsRow(Generations* gen, int yidx, Rule rule)
+{
+    int stride = gen->stride;
+    int numPlanes = gen->numPlanes;
+    int numWords = gen->numWords;
+    int lastRow = gen->numYCells - 1;
+    const uint64_t* up = GetRow(gen->Front, gen, yidx > 0 ? yidx - 1 : 0);
+    const uint64_t* mid = GetRow(gen->Front, gen, yidx);
+    const uint64_t* down = GetRow(gen->Front, gen, yidx < lastRow ? yidx + 1 : lastRow);
+    uint64_t* out = GetRow(gen->Back, gen, yidx);
+
+    uint64_t u = LiveWord(up, numPlanes, stride, 0);
+    uint64_t m = LiveWord(mid, numPlanes, stride, 0);
+    uint64_t d = LiveWord(down, numPlanes, stride, 0);
+    uint64_t up_ = u << 63, mp = m << 63, dp = d << 63;
+    uint64_t edge = gen->lastMask & ~(gen->lastMask >> 1);
+
+    for (int widx = 0; widx < numWords; widx++)
+    {
+        uint64_t ue, me, de, un = 0, mn = 0, dn = 0, mask = ~0ULL;
+        if (widx < numWords - 1)
+        {
+            un = LiveWord(up, numPlanes, stride, widx + 1);
+            mn = LiveWord(mid, numPlanes, stride, widx + 1);
+            dn = LiveWord(down, numPlanes, stride, widx + 1);
+            ue = East(u, un);
+            me = East(m, mn);
+            de = East(d, dn);
+        }
+        else
+        {
+            ue = (u >> 1) | (u & edge);
+            me = (m >> 1) | (m & edge);
+            de = (d >> 1) | (d & edge);
+            mask = gen->lastMask;
+        }
+
+        uint64_t next = LifeWord<RULE_RUNTIME, RULE_RUNTIME>(West(u, up_), u, ue,
+                                                             West(m, mp), m, me,
+                                                             West(d, dp), d, de, rule);
+        UpdateStates(mid, out, numPlanes, gen->numStates, stride, widx, m, next, mask);
+
+        up_ = u; mp = m; dp = d;
+        u = un; m = mn; d = dn;
+    }
+}
+
+static void UpdateGenerationsRows(Generations* gen, int yBegin, int yEnd)
+{
+    Rule rule = GetRule();
+    for (int yidx = yBegin; yidx < yEnd; yidx++)
+    {
+        UpdateGenerationsRow(gen, yidx, rule);
+    }
+}
+
+struct GenerationsBands
+{
+    Generations* gen;
+    int numBands;
+};
+
+static void UpdateGenerationsBand(void* context, int taskIdx, int threadIdx)
+{
+    const GenerationsBands* bands = (const GenerationsBands*)context;
+    int yBegin, yEnd;
+
+    GetBandRows(bands->gen->numYCells, 1, bands->numBands, taskIdx, &yBegin, &yEnd);
+    UpdateGenerationsRows(bands->gen, yBegin, yEnd);
+}
+
+bool UpdateGenerations(Generations* gen, ThreadPool* pool)
+{
+    if (gen->Front == NULL || gen->Back == NULL)
+    {
+        printf("UpdateGenerations fail\n");
+        return false;
+    }
+
+    if (pool != NULL && pool->numThreads > 1)
+    {
+        GenerationsBands bands = { gen, pool->numThreads };
+        RunThreadPool(pool, UpdateGenerationsBand, &bands, bands.numBands);
+    }
+    else
+    {
+        UpdateGenerationsRows(gen, 0, gen->numYCells);
+    }
+
+    uint64_t* tmp = gen->Front;
+    gen->Front = gen->Back;
+    gen->Back = tmp;
+
+    return true;
+}
+
+uint8_t GetGenerationsCell(const Generations* gen, int xidx, int yidx)
+{
+    const uint64_t* row = GetRow(gen->Front, gen, yidx);
+    uint8_t state = 0;
+    for (int p = 0; p < gen->numPlanes; p++)
+    {
+        state |= ((row[(size_t)gen->stride * p + (xidx >> 6)] >> (xidx & 63)) & 1) << p;
+    }
+    return state;
+}
+
+// States outside the rule are stored as dead
+void SetGenerationsCell(Generations* gen, int xidx, int yidx, uint8_t state)
+{
+    uint64_t* row = GetRow(gen->Front, gen, yidx);
+    uint64_t bit = 1ULL << (xidx & 63);
+    if (state >= gen->numStates)
+        state = 0;
+    for (int p = 0; p < gen->numPlanes; p++)
+    {
+        uint64_t* word = &row[(size_t)gen->stride * p + (xidx >> 6)];
+        if ((state >> p) & 1)
+            *word |= bit;
+        else
+            *word &= ~bit;
+    }
+}
+
+void LoadGenerations(Generations* gen, const bool* Cells)
+{
+    for (int yidx = 0; yidx < gen->numYCells; yidx++)
+    {
+        uint64_t* row = GetRow(gen->Front, gen, yidx);
+        const bool* src = Cells + (size_t)gen->numXCells * yidx;
+
+        memset(row, 0, (size_t)gen->stride * gen->numPlanes * sizeof(uint64_t));
+        for (int xidx = 0; xidx < gen->numXCells; xidx++)
+        {
+            if (src[xidx])
+                row[xidx >> 6] |= 1ULL << (xidx & 63);
+        }
+    }
+}
+
+// Only state 1 is live, refractory cells are stored as dead
+void StoreGenerations(const Generations* gen, bool* Cells)
+{
+    for (int yidx = 0; yidx < gen->numYCells; yidx++)
+    {
+        const uint64_t* row = GetRow(gen->Front, gen, yidx);
+        bool* dst = Cells + (size_t)gen->numXCells * yidx;
+
+        for (int xidx = 0; xidx < gen->numXCells; xidx++)
+        {
+            dst[xidx] = (LiveWord(row, gen->numPlanes, gen->stride, xidx >> 6) >> (xidx & 63)) & 1;
+        }
+    }
+}
+
+void LoadGenerationsStates(Generations* gen, const uint8_t* States)
+{
+    memset(gen->Front, 0, (size_t)gen->stride * gen->numPlanes * gen->numYCells * sizeof(uint64_t));
+    for (int yidx = 0; yidx < gen->numYCells; yidx++)
+    {
+        const uint8_t* src = States + (size_t)gen->numXCells * yidx;
+        for (int xidx = 0; xidx < gen->numXCells; xidx++)
+        {
+            if (src[xidx] != 0)
+                SetGenerationsCell(gen, xidx, yidx, src[xidx]);
+        }
+    }
+}
+
+void StoreGenerationsStates(const Generations* gen, uint8_t* States)
+{
+    for (int yidx = 0; yidx < gen->numYCells; yidx++)
+    {
+        uint8_t* dst = States + (size_t)gen->numXCells * yidx;
+        for (int xidx = 0; xidx < gen->numXCells; xidx++)
+        {
+            dst[xidx] = GetGenerationsCell(gen, xidx, yidx);
+        }
+    }
+}
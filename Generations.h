@@ -0,0 +1,38 @@
+#pragma once
+
+#include <stdint.h>
+#include "ThreadPool.h"
+
+#define GENERATIONS_MAX_PLANES 8
+
+/*
+Multi-state board for Generations rules, stored as bit-planes : the state of a cell is a
+numPlanes-bit number, bit p of it lives in plane p with the BitBoard layout (bit x % 64 of word x / 64).
+The planes of one row are next to each other, word w of plane p of row y is
+Front[(y * numPlanes + p) * stride + w], so one row is a single stream for the prefetcher.
+Only state 1 counts as a live neighbour, the 64-cell full adders of the BitBoard run on the
+live plane (plane 0 and no other plane set) and the refractory states are a bit-sliced increment.
+*/
+struct Generations
+{
+    int numXCells;
+    int numYCells;
+    int numWords;       // used words per plane row
+    int stride;         // words per plane row including padding
+    uint64_t lastMask;  // valid bits of the last used word
+    int numStates;
+    int numPlanes;      // bits per state
+    uint64_t* Front;
+    uint64_t* Back;
+};
+
+bool InitGenerations(Generations* gen, int numXCells, int numYCells, int numStates);
+void FreeGenerations(Generations* gen);
+bool UpdateGenerations(Generations* gen, ThreadPool* pool);
+
+uint8_t GetGenerationsCell(const Generations* gen, int xidx, int yidx);
+void SetGenerationsCell(Generations* gen, int xidx, int yidx, uint8_t state);
+void LoadGenerations(Generations* gen, const bool* Cells);
+void StoreGenerations(const Generations* gen, bool* Cells);
+void LoadGenerationsStates(Generations* gen, const uint8_t* States);
+void StoreGenerationsStates(const Generations* gen, uint8_t* States);
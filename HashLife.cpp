@@ -0,0 +1,446 @@
+#include "HashLife.h"
+#include "Memory.h"
+#include "Rule.h"
+#include <stdio.h>
+#include <string.h>
+
+static size_t HashChildren(const HashNode* nw, const HashNode* ne, const HashNode* sw, const HashNode* se)
+{
+    uint64_t h = (uint64_t)(uintptr_t)nw;
+    h = h * 0x9E3779B97F4A7C15ULL + (uint64_t)(uintptr_t)ne;
+    h = h * 0x9E3779B97F4A7C15ULL + (uint64_t)(uintptr_t)sw;
+    h = h * 0x9E3779B97F4A7C15ULL + (uint64_t)(uintptr_t)se;
+    return (size_t)(h ^ (h >> 29));
+}
+
+static HashNode* AllocNode(HashLife* hl)
+{
+    if (hl->freeNodes == NULL)
+    {
+        if (hl->numBlocks == hl->maxBlocks)
+        {
+            int maxBlocks = hl->maxBlocks * 2;
+            void** Blocks = (void**)LifeAlloc(maxBlocks * sizeof(void*));
+            if (Blocks == NULL)
+                return NULL;
+            memcpy(Blocks, hl->Blocks, hl->numBlocks * sizeof(void*));
+            LifeFree(hl->Blocks);
+            hl->Blocks = Blocks;
+            hl->maxBlocks = maxBlocks;
+        }
+
+        HashNode* block = (HashNode*)LifeAlloc(HASHLIFE_BLOCK_NODES * sizeof(HashNode));
+        if (block == NULL)
+            return NULL;
+        hl->Blocks[hl->numBlocks++] = block;
+        for (int i = 0; i < HASHLIFE_BLOCK_NODES; i++)
+        {
+            block[i].next = hl->freeNodes;
+            hl->freeNodes = &block[i];
+        }
+    }
+
+    HashNode* node = hl->freeNodes;
+    hl->freeNodes = node->next;
+    return node;
+}
+
+static void GrowTable(HashLife* hl)
+{
+    size_t tableSize = hl->tableSize * 2;
+    HashNode** Table = (HashNode**)LifeAlloc(tableSize * sizeof(HashNode*));
+    if (Table == NULL)
+        return;
+    memset(Table, 0, tableSize * sizeof(HashNode*));
+
+    for (size_t i = 0; i < hl->tableSize; i++)
+    {
+        HashNode* node = hl->Table[i];
+        while (node != NULL)
+        {
+            HashNode* next = node->next;
+            size_t h = HashChildren(node->nw, node->ne, node->sw, node->se) & (tableSize - 1);
+            node->next = Table[h];
+            Table[h] = node;
+            node = next;
+        }
+    }
+
+    LifeFree(hl->Table);
+    hl->Table = Table;
+    hl->tableSize = tableSize;
+}
+
+// The canonical node with these four children
+static HashNode* Join(HashLife* hl, HashNode* nw, HashNode* ne, HashNode* sw, HashNode* se)
+{
+    size_t h = HashChildren(nw, ne, sw, se) & (hl->tableSize - 1);
+    for (HashNode* node = hl->Table[h]; node != NULL; node = node->next)
+    {
+        if (node->nw == nw && node->ne == ne && node->sw == sw && node->se == se)
+            return node;
+    }
+
+    HashNode* node = AllocNode(hl);
+    if (node == NULL)
+    {
+        printf("HashLife node alloc fail\n");
+        return NULL;
+    }
+    node->nw = nw;
+    node->ne = ne;
+    node->sw = sw;
+    node->se = se;
+    node->result = NULL;
+    node->population = nw->population + ne->population + sw->population + se->population;
+    node->level = nw->level + 1;
+    node->isMarked = false;
+    node->next = hl->Table[h];
+    hl->Table[h] = node;
+
+    if (++hl->numNodes > hl->tableSize)
+        GrowTable(hl);
+
+    return node;
+}
+
+static HashNode* Cell(const HashLife* hl, bool live)
+{
+    return live ? hl->Live : hl->Empty[0];
+}
+
+// Centre 2x2 of a 4x4 node after one generation of the current rule
+static HashNode* Life4x4(HashLife* hl, HashNode* node)
+{
+    HashNode* quads[4] = { node->nw, node->ne, node->sw, node->se };
+    Rule rule = GetRule();
+    int grid[4][4];
+
+    for (int q = 0; q < 4; q++)
+    {
+        int x0 = (q & 1) * 2, y0 = (q >> 1) * 2;
+        grid[y0][x0] = (int)quads[q]->nw->population;
+        grid[y0][x0 + 1] = (int)quads[q]->ne->population;
+        grid[y0 + 1][x0] = (int)quads[q]->sw->population;
+        grid[y0 + 1][x0 + 1] = (int)quads[q]->se->population;
+    }
+
+    // The whole 3x3 neighbourhood, so rules in Hensel notation run as well
+    bool next[2][2];
+    for (int yidx = 1; yidx <= 2; yidx++)
+    {
+        for (int xidx = 1; xidx <= 2; xidx++)
+        {
+            int index512 = 0;
+            for (int dy = -1; dy <= 1; dy++)
+            {
+                for (int dx = -1; dx <= 1; dx++)
+                {
+                    index512 |= (grid[yidx + dy][xidx + dx] != 0) << (3 * (dx + 1) + dy + 1);
+                }
+            }
+            next[yidx - 1][xidx - 1] = IsNextLive512(rule, index512);
+        }
+    }
+
+    return Join(hl, Cell(hl, next[0][0]), Cell(hl, next[0][1]), Cell(hl, next[1][0]), Cell(hl, next[1][1]));
+}
+
+/*
+Centre half of node advanced by 2^min(step, level-2) generations.
+The nine overlapping level-1 sub-squares are advanced first, then the four level-1 squares built
+from them are either advanced again (full step) or only re-centred (smaller step).
+*/
+static HashNode* Successor(HashLife* hl, HashNode* node)
+{
+    if (node->result != NULL)
+        return node->result;
+    if (node->population == 0)
+        return node->result = node->nw;
+
+    HashNode* result;
+    if (node->level == 2)
+    {
+        result = Life4x4(hl, node);
+    }
+    else
+    {
+        HashNode* nw = node->nw;
+        HashNode* ne = node->ne;
+        HashNode* sw = node->sw;
+        HashNode* se = node->se;
+
+        HashNode* c1 = Successor(hl, nw);
+        HashNode* c2 = Successor(hl, Join(hl, nw->ne, ne->nw, nw->se, ne->sw));
+        HashNode* c3 = Successor(hl, ne);
+        HashNode* c4 = Successor(hl, Join(hl, nw->sw, nw->se, sw->nw, sw->ne));
+        HashNode* c5 = Successor(hl, Join(hl, nw->se, ne->sw, sw->ne, se->nw));
+        HashNode* c6 = Successor(hl, Join(hl, ne->sw, ne->se, se->nw, se->ne));
+        HashNode* c7 = Successor(hl, sw);
+        HashNode* c8 = Successor(hl, Join(hl, sw->ne, se->nw, sw->se, se->sw));
+        HashNode* c9 = Successor(hl, se);
+
+        if (hl->stepLog2 < node->level - 2)
+        {
+            result = Join(hl,
+                Join(hl, c1->se, c2->sw, c4->ne, c5->nw),
+                Join(hl, c2->se, c3->sw, c5->ne, c6->nw),
+                Join(hl, c4->se, c5->sw, c7->ne, c8->nw),
+                Join(hl, c5->se, c6->sw, c8->ne, c9->nw));
+        }
+        else
+        {
+            result = Join(hl,
+                Successor(hl, Join(hl, c1, c2, c4, c5)),
+                Successor(hl, Join(hl, c2, c3, c5, c6)),
+                Successor(hl, Join(hl, c4, c5, c7, c8)),
+                Successor(hl, Join(hl, c5, c6, c8, c9)));
+        }
+    }
+
+    return node->result = result;
+}
+
+// Same square one level up, the old root in the centre
+static HashNode* Expand(HashLife* hl, HashNode* node)
+{
+    HashNode* empty = hl->Empty[node->level - 1];
+
+    return Join(hl,
+        Join(hl, empty, empty, empty, node->nw),
+        Join(hl, empty, empty, node->ne, empty),
+        Join(hl, empty, node->sw, empty, empty),
+        Join(hl, node->se, empty, empty, empty));
+}
+
+// All live cells lie in the centre half of the node
+static bool IsPadded(const HashNode* node)
+{
+    return node->level >= 3 &&
+        node->nw->population == node->nw->se->se->population &&
+        node->ne->population == node->ne->sw->sw->population &&
+        node->sw->population == node->sw->ne->ne->population &&
+        node->se->population == node->se->nw->nw->population;
+}
+
+static void MarkNode(HashNode* node)
+{
+    if (node->isMarked)
+        return;
+    node->isMarked = true;
+    if (node->level > 0)
+    {
+        MarkNode(node->nw);
+        MarkNode(node->ne);
+        MarkNode(node->sw);
+        MarkNode(node->se);
+    }
+}
+
+// Keeps the nodes reachable from the root and the empty squares, and the results that point to them
+static void CollectGarbage(HashLife* hl)
+{
+    MarkNode(hl->root);
+    for (int level = 0; level <= HASHLIFE_MAX_LEVEL; level++)
+    {
+        MarkNode(hl->Empty[level]);
+    }
+    hl->Live->isMarked = true;
+
+    for (size_t i = 0; i < hl->tableSize; i++)
+    {
+        HashNode** link = &hl->Table[i];
+        while (*link != NULL)
+        {
+            HashNode* node = *link;
+            if (node->isMarked)
+            {
+                link = &node->next;
+                continue;
+            }
+            *link = node->next;
+            node->next = hl->freeNodes;
+            hl->freeNodes = node;
+            hl->numNodes--;
+        }
+    }
+
+    for (size_t i = 0; i < hl->tableSize; i++)
+    {
+        for (HashNode* node = hl->Table[i]; node != NULL; node = node->next)
+        {
+            if (node->result != NULL && node->result->isMarked != true)
+                node->result = NULL;
+        }
+    }
+    for (size_t i = 0; i < hl->tableSize; i++)
+    {
+        for (HashNode* node = hl->Table[i]; node != NULL; node = node->next)
+        {
+            node->isMarked = false;
+        }
+    }
+}
+
+static void ClearResults(HashLife* hl)
+{
+    for (size_t i = 0; i < hl->tableSize; i++)
+    {
+        for (HashNode* node = hl->Table[i]; node != NULL; node = node->next)
+        {
+            node->result = NULL;
+        }
+    }
+}
+
+bool InitHashLife(HashLife* hl)
+{
+    memset(hl, 0, sizeof(HashLife));
+
+    hl->tableSize = 1 << 16;
+    hl->maxBlocks = 64;
+    hl->Table = (HashNode**)LifeAlloc(hl->tableSize * sizeof(HashNode*));
+    hl->Blocks = (void**)LifeAlloc(hl->maxBlocks * sizeof(void*));
+    HashNode* dead = hl->Table != NULL && hl->Blocks != NULL ? AllocNode(hl) : NULL;
+    HashNode* live = dead != NULL ? AllocNode(hl) : NULL;
+    if (live == NULL)
+    {
+        printf("InitHashLife fail\n");
+        FreeHashLife(hl);
+        return false;
+    }
+    memset(hl->Table, 0, hl->tableSize * sizeof(HashNode*));
+
+    // The two cells are not in the table, they have no children to hash
+    memset(dead, 0, sizeof(HashNode));
+    memset(live, 0, sizeof(HashNode));
+    live->population = 1;
+    hl->Empty[0] = dead;
+    hl->Live = live;
+    for (int level = 1; level <= HASHLIFE_MAX_LEVEL; level++)
+    {
+        HashNode* empty = hl->Empty[level - 1];
+        hl->Empty[level] = Join(hl, empty, empty, empty, empty);
+    }
+    hl->root = hl->Empty[3];
+
+    return true;
+}
+
+void FreeHashLife(HashLife* hl)
+{
+    for (int i = 0; i < hl->numBlocks; i++)
+    {
+        LifeFree(hl->Blocks[i]);
+    }
+    LifeFree(hl->Blocks);
+    LifeFree(hl->Table);
+    memset(hl, 0, sizeof(HashLife));
+}
+
+void SetHashLifeStep(HashLife* hl, int stepLog2)
+{
+    if (stepLog2 < 0)
+        stepLog2 = 0;
+    if (stepLog2 > HASHLIFE_MAX_LEVEL - 4)
+        stepLog2 = HASHLIFE_MAX_LEVEL - 4;
+    if (stepLog2 == hl->stepLog2)
+        return;
+
+    // Cached results hold the old step
+    hl->stepLog2 = stepLog2;
+    ClearResults(hl);
+}
+
+bool StepHashLife(HashLife* hl)
+{
+    if (hl->numNodes > HASHLIFE_GC_NODES)
+        CollectGarbage(hl);
+
+    // Live cells in the centre quarter, so they cannot leave the centre half within 2^step generations
+    HashNode* root = hl->root;
+    while (root->level < hl->stepLog2 + 3 || IsPadded(root) != true)
+    {
+        root = Expand(hl, root);
+    }
+    root = Successor(hl, Expand(hl, root));
+    if (root == NULL)
+    {
+        printf("StepHashLife fail\n");
+        return false;
+    }
+
+    hl->root = root;
+    hl->generation += 1ULL << hl->stepLog2;
+    return true;
+}
+
+// Advances any number of generations, one power-of-two step per set bit
+bool AdvanceHashLife(HashLife* hl, uint64_t generations)
+{
+    int stepLog2 = hl->stepLog2;
+
+    for (int bit = 63; bit >= 0; bit--)
+    {
+        if ((generations >> bit & 1) == 0)
+            continue;
+        SetHashLifeStep(hl, bit);
+        if (StepHashLife(hl) != true)
+            return false;
+    }
+    SetHashLifeStep(hl, stepLog2);
+
+    return true;
+}
+
+static HashNode* Build(HashLife* hl, const bool* Cells, int numXCells, int numYCells, int level, int64_t x0, int64_t y0)
+{
+    int64_t size = (int64_t)1 << level;
+    if (x0 >= numXCells || y0 >= numYCells || x0 + size <= 0 || y0 + size <= 0)
+        return hl->Empty[level];
+    if (level == 0)
+        return Cell(hl, Cells[x0 + numXCells * y0]);
+
+    int64_t half = size / 2;
+    return Join(hl,
+        Build(hl, Cells, numXCells, numYCells, level - 1, x0, y0),
+        Build(hl, Cells, numXCells, numYCells, level - 1, x0 + half, y0),
+        Build(hl, Cells, numXCells, numYCells, level - 1, x0, y0 + half),
+        Build(hl, Cells, numXCells, numYCells, level - 1, x0 + half, y0 + half));
+}
+
+void LoadHashLife(HashLife* hl, const bool* Cells, int numXCells, int numYCells)
+{
+    int level = 3;
+    while (((int64_t)1 << (level - 1)) < numXCells || ((int64_t)1 << (level - 1)) < numYCells)
+        level++;
+
+    int64_t origin = -((int64_t)1 << (level - 1));
+    hl->root = Build(hl, Cells, numXCells, numYCells, level, origin, origin);
+}
+
+static void Write(const HashNode* node, bool* Cells, int numXCells, int numYCells, int64_t x0, int64_t y0)
+{
+    int64_t size = (int64_t)1 << node->level;
+    if (node->population == 0 || x0 >= numXCells || y0 >= numYCells || x0 + size <= 0 || y0 + size <= 0)
+        return;
+    if (node->level == 0)
+    {
+        Cells[x0 + numXCells * y0] = true;
+        return;
+    }
+
+    int64_t half = size / 2;
+    Write(node->nw, Cells, numXCells, numYCells, x0, y0);
+    Write(node->ne, Cells, numXCells, numYCells, x0 + half, y0);
+    Write(node->sw, Cells, numXCells, numYCells, x0, y0 + half);
+    Write(node->se, Cells, numXCells, numYCells, x0 + half, y0 + half);
+}
+
+void StoreHashLife(const HashLife* hl, bool* Cells, int numXCells, int numYCells)
+{
+    int64_t origin = -((int64_t)1 << (hl->root->level - 1));
+
+    memset(Cells, 0, (size_t)numXCells * numYCells * sizeof(bool));
+    Write(hl->root, Cells, numXCells, numYCells, origin, origin);
+}
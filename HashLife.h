@@ -0,0 +1,55 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define HASHLIFE_MAX_LEVEL 62
+#define HASHLIFE_GC_NODES (1 << 22)  // collect garbage above this many nodes (64 bytes each)
+#define HASHLIFE_BLOCK_NODES 65536
+
+/*
+Quadtree node, hash-consed : two nodes with the same children are the same pointer.
+Level 0 nodes are the two single cells, a level k node is a 2^k x 2^k square.
+Result caches the centre 2^(k-1) square advanced by min(2^step, 2^(k-2)) generations.
+*/
+struct HashNode
+{
+    HashNode* nw;
+    HashNode* ne;
+    HashNode* sw;
+    HashNode* se;
+    HashNode* result;
+    HashNode* next;         // hash chain
+    uint64_t population;
+    int level;
+    bool isMarked;          // garbage collection
+};
+
+/*
+HashLife universe on the unbounded plane. The root is centred on the origin, cell (x, y) of the
+bool grid is plane cell (x, y), so the window shows the quadrant right and below of the origin.
+*/
+struct HashLife
+{
+    HashNode** Table;
+    size_t tableSize;
+    size_t numNodes;
+    HashNode* freeNodes;
+    void** Blocks;          // node pool blocks
+    int numBlocks;
+    int maxBlocks;
+    HashNode* Empty[HASHLIFE_MAX_LEVEL + 1];   // Empty[0] is the dead cell
+    HashNode* Live;                             // the live cell
+    HashNode* root;
+    int stepLog2;           // StepHashLife advances 2^stepLog2 generations
+    uint64_t generation;
+};
+
+bool InitHashLife(HashLife* hl);
+void FreeHashLife(HashLife* hl);
+bool StepHashLife(HashLife* hl);
+bool AdvanceHashLife(HashLife* hl, uint64_t generations);
+void SetHashLifeStep(HashLife* hl, int stepLog2);
+
+void LoadHashLife(HashLife* hl, const bool* Cells, int numXCells, int numYCells);
+void StoreHashLife(const HashLife* hl, bool* Cells, int numXCells, int numYCells);
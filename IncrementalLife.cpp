@@ -0,0 +1,203 @@
+#include "IncrementalLife.h"
+#include "Memory.h"
+#include "Rule.h"
+#include <stdio.h>
+#include <string.h>
+
+bool InitIncrementalLife(IncrementalLife* il, int numXCells, int numYCells)
+{
+    memset(il, 0, sizeof(IncrementalLife));
+    il->numXCells = numXCells;
+    il->numYCells = numYCells;
+
+    size_t numCells = (size_t)numXCells * numYCells;
+    il->Cells = (bool*)LifeAlloc(numCells * sizeof(bool));
+    il->Counts = (uint8_t*)LifeAlloc(numCells);
+    il->Queued = (uint8_t*)LifeAlloc(numCells);
+    il->Candidates = (int*)LifeAlloc(numCells * sizeof(int));
+    il->Changed = (int*)LifeAlloc(numCells * sizeof(int));
+    il->Flips = (int*)LifeAlloc(numCells * sizeof(int));
+    if (il->Cells == NULL || il->Counts == NULL || il->Queued == NULL ||
+        il->Candidates == NULL || il->Changed == NULL || il->Flips == NULL)
+    {
+        printf("IncrementalLife LifeAlloc fail\n");
+        FreeIncrementalLife(il);
+        return false;
+    }
+    memset(il->Cells, 0, numCells * sizeof(bool));
+    memset(il->Counts, 0, numCells);
+    memset(il->Queued, 0, numCells);
+
+    return true;
+}
+
+void FreeIncrementalLife(IncrementalLife* il)
+{
+    LifeFree(il->Cells);
+    LifeFree(il->Counts);
+    LifeFree(il->Queued);
+    LifeFree(il->Candidates);
+    LifeFree(il->Changed);
+    LifeFree(il->Flips);
+    il->Cells = NULL;
+    il->Counts = NULL;
+    il->Queued = NULL;
+    il->Candidates = NULL;
+    il->Changed = NULL;
+    il->Flips = NULL;
+}
+
+// Offsets d in {-1, 0, 1} that clamp position c + d onto position l
+static inline int Multiplicity(int c, int l, int n)
+{
+    int count = 0;
+    for (int d = -1; d <= 1; d++)
+    {
+        int p = c + d < 0 ? 0 : (c + d > n - 1 ? n - 1 : c + d);
+        count += p == l;
+    }
+    return count;
+}
+
+// Adds delta to the count of every cell that has cell idx as a neighbour
+static void AddNeighbours(IncrementalLife* il, int idx, int delta)
+{
+    int width = il->numXCells;
+    int height = il->numYCells;
+    int xidx = idx % width;
+    int yidx = idx / width;
+
+    if (xidx > 0 && xidx < width - 1 && yidx > 0 && yidx < height - 1)
+    {
+        uint8_t* up = il->Counts + idx - width;
+        uint8_t* mid = il->Counts + idx;
+        uint8_t* down = il->Counts + idx + width;
+        up[-1] += delta; up[0] += delta; up[1] += delta;
+        mid[-1] += delta; mid[1] += delta;
+        down[-1] += delta; down[0] += delta; down[1] += delta;
+        return;
+    }
+
+    // Window Boundary Rule
+    int yBegin = yidx > 0 ? yidx - 1 : 0;
+    int yEnd = yidx < height - 1 ? yidx + 1 : height - 1;
+    int xBegin = xidx > 0 ? xidx - 1 : 0;
+    int xEnd = xidx < width - 1 ? xidx + 1 : width - 1;
+    for (int cy = yBegin; cy <= yEnd; cy++)
+    {
+        int wy = Multiplicity(cy, yidx, height);
+        for (int cx = xBegin; cx <= xEnd; cx++)
+        {
+            int weight = wy * Multiplicity(cx, xidx, width) - (cx == xidx && cy == yidx);
+            il->Counts[cx + width * cy] += delta * weight;
+        }
+    }
+}
+
+static inline bool NextState(const IncrementalLife* il, Rule rule, int idx)
+{
+    return IsNextLive(rule, il->Cells[idx], il->Counts[idx]);
+}
+
+// Queues the 3x3 neighbourhood of every changed cell once
+static void CollectCandidates(IncrementalLife* il)
+{
+    int width = il->numXCells;
+    int height = il->numYCells;
+    int numCandidates = 0;
+
+    for (int i = 0; i < il->numChanged; i++)
+    {
+        int xidx = il->Changed[i] % width;
+        int yidx = il->Changed[i] / width;
+        int yBegin = yidx > 0 ? yidx - 1 : 0;
+        int yEnd = yidx < height - 1 ? yidx + 1 : height - 1;
+        int xBegin = xidx > 0 ? xidx - 1 : 0;
+        int xEnd = xidx < width - 1 ? xidx + 1 : width - 1;
+        for (int cy = yBegin; cy <= yEnd; cy++)
+        {
+            for (int cx = xBegin; cx <= xEnd; cx++)
+            {
+                int idx = cx + width * cy;
+                if (il->Queued[idx] == 0)
+                {
+                    il->Queued[idx] = 1;
+                    il->Candidates[numCandidates++] = idx;
+                }
+            }
+        }
+    }
+
+    il->numCandidates = numCandidates;
+}
+
+/*
+All flips are found from the old counts first and applied afterwards, so every cell sees generation t.
+*/
+bool UpdateIncrementalLife(IncrementalLife* il)
+{
+    if (il->Cells == NULL || il->Counts == NULL)
+    {
+        printf("UpdateIncrementalLife fail\n");
+        return false;
+    }
+
+    Rule rule = GetRule();
+    int numFlips = 0;
+    if (il->isFullScan)
+    {
+        int numCells = il->numXCells * il->numYCells;
+        for (int idx = 0; idx < numCells; idx++)
+        {
+            if (NextState(il, rule, idx) != il->Cells[idx])
+                il->Flips[numFlips++] = idx;
+        }
+        il->numCandidates = numCells;
+        il->isFullScan = false;
+    }
+    else
+    {
+        CollectCandidates(il);
+        for (int i = 0; i < il->numCandidates; i++)
+        {
+            int idx = il->Candidates[i];
+            il->Queued[idx] = 0;
+            if (NextState(il, rule, idx) != il->Cells[idx])
+                il->Flips[numFlips++] = idx;
+        }
+    }
+
+    for (int i = 0; i < numFlips; i++)
+    {
+        int idx = il->Flips[i];
+        il->Cells[idx] = !il->Cells[idx];
+        AddNeighbours(il, idx, il->Cells[idx] ? 1 : -1);
+    }
+
+    int* tmp = il->Changed;
+    il->Changed = il->Flips;
+    il->Flips = tmp;
+    il->numChanged = numFlips;
+
+    return true;
+}
+
+void LoadIncrementalLife(IncrementalLife* il, const bool* Cells)
+{
+    int numCells = il->numXCells * il->numYCells;
+
+    memcpy(il->Cells, Cells, numCells * sizeof(bool));
+    memset(il->Counts, 0, numCells);
+    for (int idx = 0; idx < numCells; idx++)
+    {
+        if (Cells[idx])
+            AddNeighbours(il, idx, 1);
+    }
+    il->numChanged = 0;
+    il->isFullScan = true;
+}
+
+void StoreIncrementalLife(const IncrementalLife* il, bool* Cells)
+{
+    memcpy(Cells, il->Cells, (size_t)il->numXCells * il->numYCells * sizeof(bool));
+}
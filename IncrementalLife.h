@@ -0,0 +1,33 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+Neighbour counts kept between generations : only the cells that flipped in the last generation
+update the counts around them, and only the cells next to them are evaluated,
+so a generation costs O(changed cells) instead of O(area).
+Window Boundary Rule : same clamping as CheckRule, a cell on the edge is counted as its own
+neighbour beyond the edge, so its count changes by more than one around the edge.
+*/
+struct IncrementalLife
+{
+    int numXCells;
+    int numYCells;
+    bool* Cells;            // current generation
+    uint8_t* Counts;        // live neighbours of every cell
+    uint8_t* Queued;        // cell is already in Candidates
+    int* Candidates;        // cells to evaluate this generation
+    int* Changed;           // cells that flipped in the last generation
+    int* Flips;             // cells that flip in this generation, swapped with Changed
+    int numChanged;
+    int numCandidates;      // cells evaluated in the last update
+    bool isFullScan;        // after a load every cell has to be evaluated once
+};
+
+bool InitIncrementalLife(IncrementalLife* il, int numXCells, int numYCells);
+void FreeIncrementalLife(IncrementalLife* il);
+bool UpdateIncrementalLife(IncrementalLife* il);
+
+void LoadIncrementalLife(IncrementalLife* il, const bool* Cells);
+void StoreIncrementalLife(const IncrementalLife* il, bool* Cells);
@@ -0,0 +1,326 @@
+#include "LargerThanLife.h"
+#include "Memory.h"
+#include "Rule.h"
+#include <stdio.h>
+#include <string.h>
+
+bool InitLargerThanLife(LargerThanLife* ltl, int numXCells, int numYCells, int numBands)
+{
+    Rule rule = GetRule();
+
+    memset(ltl, 0, sizeof(LargerThanLife));
+    ltl->numXCells = numXCells;
+    ltl->numYCells = numYCells;
+    ltl->range = rule.hasRange ? rule.range : 1;
+    ltl->isVonNeumann = rule.hasRange && rule.neighbourhood == NEIGHBOURHOOD_VON_NEUMANN;
+    ltl->hasCentre = rule.hasRange && rule.hasCentre;
+    ltl->margin = ltl->range + 2;
+    ltl->stride = numXCells + 2 * ltl->margin;
+    ltl->numBands = numBands > 0 ? numBands : 1;
+    int range = ltl->range;
+    ltl->maxCount = ltl->isVonNeumann ? 2 * range * (range + 1) + 1 : (2 * range + 1) * (2 * range + 1);
+
+    size_t size = (size_t)ltl->stride * (numYCells + 2 * ltl->margin);
+    ltl->NextState = (uint8_t*)LifeAlloc((ltl->maxCount + 1) * 2);
+    ltl->Front = (uint8_t*)LifeAlloc(size);
+    ltl->Back = (uint8_t*)LifeAlloc(size);
+    ltl->Scratch = (int*)LifeAlloc((size_t)ltl->numBands * 6 * (ltl->stride + 1) * sizeof(int));
+    if (ltl->NextState == NULL || ltl->Front == NULL || ltl->Back == NULL || ltl->Scratch == NULL)
+    {
+        printf("LargerThanLife LifeAlloc fail\n");
+        FreeLargerThanLife(ltl);
+        return false;
+    }
+    memset(ltl->Front, 0, size);
+    memset(ltl->Back, 0, size);
+
+    for (int count = 0; count <= ltl->maxCount; count++)
+    {
+        if (rule.hasRange)
+        {
+            ltl->NextState[count * 2] = count >= rule.birthMin && count <= rule.birthMax;
+            ltl->NextState[count * 2 + 1] = count >= rule.survivalMin && count <= rule.survivalMax;
+        }
+        else
+        {
+            ltl->NextState[count * 2] = count <= 8 && IsNextLive(rule, false, count);
+            ltl->NextState[count * 2 + 1] = count <= 8 && IsNextLive(rule, true, count);
+        }
+    }
+
+    return true;
+}
+
+void FreeLargerThanLife(LargerThanLife* ltl)
+{
+    LifeFree(ltl->NextState);
+    LifeFree(ltl->Front);
+    LifeFree(ltl->Back);
+    LifeFree(ltl->Scratch);
+    ltl->NextState = NULL;
+    ltl->Front = NULL;
+    ltl->Back = NULL;
+    ltl->Scratch = NULL;
+}
+
+// Window Boundary Rule : the margin repeats the edge cells, the corners come with the top and bottom rows
+static void FillMargin(LargerThanLife* ltl)
+{
+    int stride = ltl->stride;
+    int margin = ltl->margin;
+    int numXCells = ltl->numXCells;
+    int numYCells = ltl->numYCells;
+
+    for (int py = margin; py < margin + numYCells; py++)
+    {
+        uint8_t* row = ltl->Front + (size_t)stride * py;
+        memset(row, row[margin], margin);
+        memset(row + margin + numXCells, row[margin + numXCells - 1], margin);
+    }
+    for (int py = 0; py < margin; py++)
+    {
+        memcpy(ltl->Front + (size_t)stride * py, ltl->Front + (size_t)stride * margin, stride);
+        memcpy(ltl->Front + (size_t)stride * (margin + numYCells + py),
+            ltl->Front + (size_t)stride * (margin + numYCells - 1), stride);
+    }
+}
+
+static void UpdateMooreRows(LargerThanLife* ltl, int yBegin, int yEnd, int* Scratch)
+{
+    const uint8_t* Cells = ltl->Front;
+    int range = ltl->range;
+    int stride = ltl->stride;
+    int margin = ltl->margin;
+    int pxBegin = margin - range;
+    int pxEnd = margin + ltl->numXCells + range + 1;
+    int* ColumnSums = Scratch;
+
+    for (int px = pxBegin; px < pxEnd; px++)
+    {
+        int sum = 0;
+        for (int dy = -range; dy <= range; dy++)
+        {
+            sum += Cells[(size_t)stride * (yBegin + margin + dy) + px];
+        }
+        ColumnSums[px] = sum;
+    }
+
+    for (int py = yBegin + margin; py < yEnd + margin; py++)
+    {
+        const uint8_t* mid = Cells + (size_t)stride * py;
+        uint8_t* out = ltl->Back + (size_t)stride * py;
+        int count = 0;
+        for (int px = margin - range; px <= margin + range; px++)
+        {
+            count += ColumnSums[px];
+        }
+        for (int px = margin; px < margin + ltl->numXCells; px++)
+        {
+            out[px] = ltl->NextState[(count - (ltl->hasCentre ? 0 : mid[px])) * 2 + mid[px]];
+            count += ColumnSums[px + range + 1] - ColumnSums[px - range];
+        }
+
+        const uint8_t* enter = Cells + (size_t)stride * (py + range + 1);
+        const uint8_t* leave = Cells + (size_t)stride * (py - range);
+        for (int px = pxBegin; px < pxEnd; px++)
+        {
+            ColumnSums[px] += enter[px] - leave[px];
+        }
+    }
+}
+
+/*
+Diagonal sums of range + 1 cells starting in row r :
+Down[q] runs down and right from (r, q), Up[q] runs down and left from (r, q).
+*/
+struct DiagonalSums
+{
+    int* Down;
+    int* Up;
+    int row;
+};
+
+static int SumDown(const LargerThanLife* ltl, int row, int q)
+{
+    int sum = 0;
+    for (int k = 0; k <= ltl->range; k++)
+    {
+        sum += ltl->Front[(size_t)ltl->stride * (row + k) + q + k];
+    }
+    return sum;
+}
+
+static int SumUp(const LargerThanLife* ltl, int row, int q)
+{
+    int sum = 0;
+    for (int k = 0; k <= ltl->range; k++)
+    {
+        sum += ltl->Front[(size_t)ltl->stride * (row + k) + q - k];
+    }
+    return sum;
+}
+
+// Down is kept for q in [margin - range, margin + numXCells), Up for q in [margin, margin + numXCells + range)
+static void InitDiagonalSums(const LargerThanLife* ltl, DiagonalSums* diag, int row)
+{
+    int margin = ltl->margin;
+    diag->row = row;
+    for (int q = margin - ltl->range; q < margin + ltl->numXCells; q++)
+    {
+        diag->Down[q] = SumDown(ltl, row, q);
+    }
+    for (int q = margin; q < margin + ltl->numXCells + ltl->range; q++)
+    {
+        diag->Up[q] = SumUp(ltl, row, q);
+    }
+}
+
+// Moves the sums one row down : every diagonal loses its first cell and gains one at the end
+static void AdvanceDiagonalSums(const LargerThanLife* ltl, DiagonalSums* diag)
+{
+    int range = ltl->range;
+    int margin = ltl->margin;
+    int downBegin = margin - range;
+    int upEnd = margin + ltl->numXCells + range;
+    const uint8_t* first = ltl->Front + (size_t)ltl->stride * diag->row;
+    const uint8_t* last = ltl->Front + (size_t)ltl->stride * (diag->row + range + 1);
+
+    for (int q = margin + ltl->numXCells - 1; q > downBegin; q--)
+    {
+        diag->Down[q] = diag->Down[q - 1] - first[q - 1] + last[q + range];
+    }
+    for (int q = margin; q < upEnd - 1; q++)
+    {
+        diag->Up[q] = diag->Up[q + 1] - first[q + 1] + last[q - range];
+    }
+    diag->row++;
+    diag->Down[downBegin] = SumDown(ltl, diag->row, downBegin);
+    diag->Up[upEnd - 1] = SumUp(ltl, diag->row, upEnd - 1);
+}
+
+/*
+Count of row py from row py - 1 : the lower edge of the diamond of py is two diagonals starting in row py,
+the upper edge of the diamond of py - 1 is two diagonals starting in row py - 1 - range.
+*/
+static void UpdateVonNeumannRows(LargerThanLife* ltl, int yBegin, int yEnd, int* Scratch)
+{
+    const uint8_t* Cells = ltl->Front;
+    int range = ltl->range;
+    int stride = ltl->stride;
+    int margin = ltl->margin;
+    int pyBegin = yBegin + margin;
+    int* Counts = Scratch;
+    int* Prefix = Scratch + (stride + 1);
+    DiagonalSums lower = { Scratch + 2 * (stride + 1), Scratch + 3 * (stride + 1), 0 };
+    DiagonalSums upper = { Scratch + 4 * (stride + 1), Scratch + 5 * (stride + 1), 0 };
+
+    // First row of the band : row segments of the diamond from prefix sums
+    memset(Counts, 0, stride * sizeof(int));
+    for (int dy = -range; dy <= range; dy++)
+    {
+        const uint8_t* row = Cells + (size_t)stride * (pyBegin + dy);
+        int width = range - (dy < 0 ? -dy : dy);
+        Prefix[0] = 0;
+        for (int px = 0; px < stride; px++)
+        {
+            Prefix[px + 1] = Prefix[px] + row[px];
+        }
+        for (int px = margin; px < margin + ltl->numXCells; px++)
+        {
+            Counts[px] += Prefix[px + width + 1] - Prefix[px - width];
+        }
+    }
+    InitDiagonalSums(ltl, &lower, pyBegin + 1);
+    InitDiagonalSums(ltl, &upper, pyBegin - range);
+
+    for (int py = pyBegin; py < yEnd + margin; py++)
+    {
+        const uint8_t* mid = Cells + (size_t)stride * py;
+        uint8_t* out = ltl->Back + (size_t)stride * py;
+        if (py > pyBegin)
+        {
+            const uint8_t* bottom = Cells + (size_t)stride * (py + range);
+            const uint8_t* top = Cells + (size_t)stride * (py - 1 - range);
+            for (int px = margin; px < margin + ltl->numXCells; px++)
+            {
+                Counts[px] += lower.Down[px - range] + lower.Up[px + range] - bottom[px] -
+                    (upper.Down[px] + upper.Up[px] - top[px]);
+            }
+            AdvanceDiagonalSums(ltl, &lower);
+            AdvanceDiagonalSums(ltl, &upper);
+        }
+        for (int px = margin; px < margin + ltl->numXCells; px++)
+        {
+            out[px] = ltl->NextState[(Counts[px] - (ltl->hasCentre ? 0 : mid[px])) * 2 + mid[px]];
+        }
+    }
+}
+
+static void UpdateLargerThanLifeBand(void* context, int taskIdx, int threadIdx)
+{
+    LargerThanLife* ltl = (LargerThanLife*)context;
+    int* Scratch = ltl->Scratch + (size_t)taskIdx * 6 * (ltl->stride + 1);
+    int yBegin, yEnd;
+
+    GetBandRows(ltl->numYCells, 1, ltl->numBands, taskIdx, &yBegin, &yEnd);
+    if (yBegin >= yEnd)
+        return;
+    if (ltl->isVonNeumann)
+        UpdateVonNeumannRows(ltl, yBegin, yEnd, Scratch);
+    else
+        UpdateMooreRows(ltl, yBegin, yEnd, Scratch);
+}
+
+bool UpdateLargerThanLife(LargerThanLife* ltl, ThreadPool* pool)
+{
+    if (ltl->Front == NULL || ltl->Back == NULL)
+    {
+        printf("UpdateLargerThanLife fail\n");
+        return false;
+    }
+
+    FillMargin(ltl);
+    if (pool != NULL && pool->numThreads > 1)
+    {
+        RunThreadPool(pool, UpdateLargerThanLifeBand, ltl, ltl->numBands);
+    }
+    else
+    {
+        for (int band = 0; band < ltl->numBands; band++)
+        {
+            UpdateLargerThanLifeBand(ltl, band, 0);
+        }
+    }
+
+    uint8_t* tmp = ltl->Front;
+    ltl->Front = ltl->Back;
+    ltl->Back = tmp;
+
+    return true;
+}
+
+void LoadLargerThanLife(LargerThanLife* ltl, const bool* Cells)
+{
+    for (int yidx = 0; yidx < ltl->numYCells; yidx++)
+    {
+        uint8_t* row = ltl->Front + (size_t)ltl->stride * (yidx + ltl->margin) + ltl->margin;
+        const bool* src = Cells + (size_t)ltl->numXCells * yidx;
+        for (int xidx = 0; xidx < ltl->numXCells; xidx++)
+        {
+            row[xidx] = src[xidx];
+        }
+    }
+}
+
+void StoreLargerThanLife(const LargerThanLife* ltl, bool* Cells)
+{
+    for (int yidx = 0; yidx < ltl->numYCells; yidx++)
+    {
+        const uint8_t* row = ltl->Front + (size_t)ltl->stride * (yidx + ltl->margin) + ltl->margin;
+        bool* dst = Cells + (size_t)ltl->numXCells * yidx;
+        for (int xidx = 0; xidx < ltl->numXCells; xidx++)
+        {
+            dst[xidx] = row[xidx] != 0;
+        }
+    }
+}
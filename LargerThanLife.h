@@ -0,0 +1,37 @@
+#pragma once
+
+#include <stdint.h>
+#include "ThreadPool.h"
+
+/*
+Range-R rules (Larger than Life) with O(1) counting per cell instead of (2R + 1)^2 reads.
+The grid has a margin of range + 2 cells on every side that repeats the edge cells, which is the
+Window Boundary Rule of CheckRule for any range. Every band of rows keeps running sums in Scratch :
+Moore : column sums over 2R + 1 rows, moved down by one row and slid along the row.
+von Neumann : the diamond count of a row follows from the row above by adding its lower edge and
+removing the upper edge of the row above, both edges are two diagonals kept as running diagonal sums.
+B/S rules run as range 1 Moore rules, NextState maps (count, live) to the next state of either.
+*/
+struct LargerThanLife
+{
+    int numXCells;
+    int numYCells;
+    int range;
+    bool isVonNeumann;
+    bool hasCentre;     // the count includes the cell itself
+    int margin;         // range + 2
+    int stride;         // numXCells + 2 * margin
+    int maxCount;
+    int numBands;
+    uint8_t* NextState; // [count * 2 + live]
+    uint8_t* Front;     // current generation including the margin
+    uint8_t* Back;      // next generation, swapped with Front
+    int* Scratch;       // running sums, 6 rows of stride + 1 ints per band
+};
+
+bool InitLargerThanLife(LargerThanLife* ltl, int numXCells, int numYCells, int numBands);
+void FreeLargerThanLife(LargerThanLife* ltl);
+bool UpdateLargerThanLife(LargerThanLife* ltl, ThreadPool* pool);
+
+void LoadLargerThanLife(LargerThanLife* ltl, const bool* Cells);
+void StoreLargerThanLife(const LargerThanLife* ltl, bool* Cells);
@@ -0,0 +1,435 @@
+#include "LifeEngine.h"
+#include "CycleDetector.h"
+#include "CellKernel.h"
+#include "BatchMode.h"
+#include "Pattern.h"
+#include "ByteGrid.h"
+#include "LifeStats.h"
+#include "Rule.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <chrono>
+
+/*
+Headless runner : the simulation core without SDL, no window, no event loop and no frame cap.
+Runs N generations of a random board or a pattern file and reports gens/sec and cells/sec.
+Boards above CLI_GRID_CELLS cells get no bool grid : the pattern is set cell by cell on a BitBoard,
+which reserves giant boards and commits their pages where cells live.
+*/
+
+#define CLI_GRID_CELLS ((1ULL << 31) - 1)     // largest bool grid, its cell indices stay within int
+
+// Engine index, name or the start of one name, case and spaces ignored ("hashlife", "byte grid", "padded", "3")
+static bool FindEngine(const char* name, LifeEngineType* type)
+{
+	if (isdigit((unsigned char)name[0]))
+	{
+		int idx = atoi(name);
+		*type = (LifeEngineType)idx;
+		return idx >= 0 && idx < NUM_ENGINES;
+	}
+	int numPrefixes = 0;
+	for (int idx = 0; idx < NUM_ENGINES; idx++)
+	{
+		const char* a = name;
+		const char* b = GetEngineName((LifeEngineType)idx);
+		while (*a != '\0' || *b != '\0')
+		{
+			if (*a == ' ')
+				a++;
+			else if (*b == ' ')
+				b++;
+			else if (tolower((unsigned char)*a) == tolower((unsigned char)*b))
+				a++, b++;
+			else
+				break;
+		}
+		if (*a == '\0' && *b == '\0')
+		{
+			*type = (LifeEngineType)idx;
+			return true;
+		}
+		if (*a == '\0' && a != name)
+		{
+			*type = (LifeEngineType)idx;
+			numPrefixes++;
+		}
+	}
+	return numPrefixes == 1;
+}
+
+static void PrintEngines()
+{
+	printf("  engines :");
+	for (int idx = 0; idx < NUM_ENGINES; idx++)
+		printf(" %d %s%s", idx, GetEngineName((LifeEngineType)idx), idx < NUM_ENGINES - 1 ? "," : "\n");
+}
+
+// The engine built for the rule, then the byte grid
+static LifeEngineType GetDefaultEngine()
+{
+	const LifeEngineType Preferred[] = { ENGINE_BITBOARD, ENGINE_GENERATIONS, ENGINE_LARGER_THAN_LIFE,
+		ENGINE_HEXAGONAL, ENGINE_VON_NEUMANN };
+	for (LifeEngineType type : Preferred)
+	{
+		if (IsEngineSupported(type))
+			return type;
+	}
+	return ENGINE_BYTEGRID;
+}
+
+static uint64_t CountPopulation(const bool* Cells, size_t numCells)
+{
+	uint64_t population = 0;
+	for (size_t idx = 0; idx < numCells; idx++)
+		population += Cells[idx];
+	return population;
+}
+
+static void PrintUsage()
+{
+	printf("life_cli [options]\n"
+		"  --rule RULE          rule string (default B3/S23, or the rule of an RLE pattern)\n"
+		"  --engine NAME|N      simulation engine, any unique start of its name (default : the one built for the rule)\n"
+		"  --size W H           board size (default 1024 1024)\n"
+		"  --generations N      generations to run (default 1000)\n"
+		"  --step K             generations per step, 2, 4 or 8 run the byte grid with temporal blocking\n"
+		"  --seed S             random board of seed S, the same with any thread count (default : new, printed)\n"
+		"  --density D          live cells of the random board, 0 to 1 in steps of 1/256 (default 0.5)\n"
+		"  --pattern FILE       RLE or plaintext pattern centred on the board instead\n"
+		"  --threads N          worker threads (default : all cores)\n"
+		"  --stats FILE         population, births, deaths and bounding box of every generation (BitBoard),\n"
+		"                       CSV when FILE ends in .csv, binary otherwise\n"
+		"  --stop-on-cycle      stop once the board repeats with a period of 64 or less, bounded engines\n"
+		"  --bench [w h gens]   compare the engines\n"
+		"  --soups N [w h gens] search N random soups, --soup-file FILE, --soup-merge FILE\n");
+	PrintEngines();
+}
+
+int main(int argc, char** argv)
+{
+	int numThreads = 0;
+	int numXCells = 1024;
+	int numYCells = 1024;
+	unsigned long long generations = 1000;
+	int stepLog2 = 0;
+	unsigned long long seed = GetRandomSeed();
+	double density = SEED_DENSITY;
+	bool isStopOnCycle = false;
+	const char* rulestring = NULL;
+	const char* engineName = NULL;
+	const char* patternFile = NULL;
+	const char* statsPath = NULL;
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+			numThreads = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--rule") == 0 && i + 1 < argc)
+			rulestring = argv[++i];
+		else if (strcmp(argv[i], "--engine") == 0 && i + 1 < argc)
+			engineName = argv[++i];
+		else if (strcmp(argv[i], "--size") == 0 && i + 2 < argc)
+		{
+			numXCells = atoi(argv[++i]);
+			numYCells = atoi(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--generations") == 0 && i + 1 < argc)
+			generations = strtoull(argv[++i], NULL, 10);
+		else if (strcmp(argv[i], "--step") == 0 && i + 1 < argc)
+		{
+			// Generations per step, rounded down to a power of two
+			for (unsigned long long step = strtoull(argv[++i], NULL, 10); step > 1; step >>= 1)
+				stepLog2++;
+		}
+		else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+			seed = strtoull(argv[++i], NULL, 0);
+		else if (strcmp(argv[i], "--density") == 0 && i + 1 < argc)
+			density = atof(argv[++i]);
+		else if (strcmp(argv[i], "--pattern") == 0 && i + 1 < argc)
+			patternFile = argv[++i];
+		else if (strcmp(argv[i], "--stats") == 0 && i + 1 < argc)
+			statsPath = argv[++i];
+		else if (strcmp(argv[i], "--stop-on-cycle") == 0)
+			isStopOnCycle = true;
+		// Batch options, RunBatchMode parses them again
+		else if (strcmp(argv[i], "--bench") == 0)
+			continue;
+		else if ((strcmp(argv[i], "--soups") == 0 || strcmp(argv[i], "--soup-file") == 0 ||
+			strcmp(argv[i], "--soup-merge") == 0) && i + 1 < argc)
+			i++;
+		else if (strcmp(argv[i], "--help") == 0)
+		{
+			PrintUsage();
+			return 0;
+		}
+		else if (argv[i][0] == '-')
+		{
+			printf("Unknown option %s\n", argv[i]);
+			PrintUsage();
+			return -1;
+		}
+	}
+
+	// --bench, --soups and --soup-merge run the batch of life_core instead of a board
+	int exitCode = 0;
+	if (RunBatchMode(argc, argv, &exitCode))
+		return exitCode;
+
+	if (numXCells <= 0 || numYCells <= 0)
+	{
+		printf("Board size %dx%d fail\n", numXCells, numYCells);
+		return -1;
+	}
+
+	size_t numCells = (size_t)numXCells * numYCells;
+	bool isGiant = numCells > CLI_GRID_CELLS;
+	bool* Cells = NULL;
+	int* PatternXY = NULL;
+	int numPatternCells = 0;
+	char patternRule[64] = "";
+	if (isGiant)
+	{
+		if (patternFile == NULL)
+		{
+			printf("Boards above %llu cells need --pattern\n", (unsigned long long)CLI_GRID_CELLS);
+			return -1;
+		}
+		PatternXY = LoadPatternCells(patternFile, numXCells, numYCells, &numPatternCells, patternRule, sizeof(patternRule));
+		if (PatternXY == NULL)
+			return -1;
+	}
+	else if (patternFile != NULL)
+	{
+		Cells = (bool*)malloc(numCells * sizeof(bool));
+		if (Cells == NULL || LoadPattern(patternFile, Cells, numXCells, numYCells, patternRule, sizeof(patternRule)) != true)
+		{
+			free(Cells);
+			return -1;
+		}
+	}
+
+	if (rulestring == NULL)
+		rulestring = patternRule[0] != '\0' ? patternRule : "B3/S23";
+	if (SetRule(rulestring) != true)
+	{
+		free(Cells);
+		free(PatternXY);
+		return -1;
+	}
+	char ruleName[64];
+	FormatRule(GetRule(), ruleName, sizeof(ruleName));
+	printf("Rule : %s (%s kernel)\n", ruleName, GetRuleKernelName(GetRuleKernel()));
+	SelectCellKernel();
+
+	if (numThreads <= 0)
+		numThreads = GetDefaultThreadCount();
+
+	LifeEngineType type = GetDefaultEngine();
+	if (engineName != NULL && FindEngine(engineName, &type) != true)
+	{
+		printf("Unknown engine %s\n", engineName);
+		PrintEngines();
+		free(Cells);
+		free(PatternXY);
+		return -1;
+	}
+	if (isGiant && type != ENGINE_BITBOARD)
+	{
+		printf("%s runs boards up to %llu cells, larger ones need the BitBoard\n", GetEngineName(type),
+			(unsigned long long)CLI_GRID_CELLS);
+		free(PatternXY);
+		return -1;
+	}
+
+	ThreadPool pool;
+	LifeEngine engine;
+	if (InitThreadPool(&pool, numThreads) != true)
+	{
+		free(Cells);
+		free(PatternXY);
+		return -1;
+	}
+
+	if (Cells == NULL && isGiant != true)
+	{
+		Cells = (bool*)malloc(numCells * sizeof(bool));
+		if (Cells == NULL)
+		{
+			printf("Cells malloc fail\n");
+			FreeThreadPool(&pool);
+			return -1;
+		}
+		auto seedStart = std::chrono::steady_clock::now();
+		SetCells(Cells, numXCells, numYCells, seed, density, &pool);
+		double seedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - seedStart).count();
+		printf("Seed : %llu, density %.3f, %.1f Mcells/sec\n", seed, density, seedSeconds > 0.0 ? numCells / seedSeconds / 1e6 : 0.0);
+	}
+	if (InitEngine(&engine, type, numXCells, numYCells, &pool) != true)
+	{
+		FreeThreadPool(&pool);
+		free(Cells);
+		free(PatternXY);
+		return -1;
+	}
+	if (SetEngineStep(&engine, stepLog2) != true)
+	{
+		printf("%s does not run steps of %llu generations\n", GetEngineName(type), 1ULL << stepLog2);
+		FreeEngine(&engine);
+		FreeThreadPool(&pool);
+		free(Cells);
+		free(PatternXY);
+		return -1;
+	}
+	if (isGiant)
+	{
+		for (int cellIdx = 0; cellIdx < numPatternCells; cellIdx++)
+			SetEngineCell(&engine, PatternXY[2 * cellIdx], PatternXY[2 * cellIdx + 1], true);
+		free(PatternXY);
+	}
+	else
+		LoadEngine(&engine, Cells);
+	printf("%s %dx%d, %d threads, %llu generations, %llu per step\n", GetEngineName(type), numXCells, numYCells, numThreads,
+		generations, 1ULL << stepLog2);
+
+	// Stats go through the ring and are written out whenever it fills up
+	StatsRing ring;
+	StatsFile statsFile;
+	LifeStats stats;
+	bool hasStats = false;
+	if (statsPath != NULL)
+	{
+		if (SetEngineStats(&engine, true) != true)
+			printf("%s does not count stats, --stats needs the BitBoard\n", GetEngineName(type));
+		else if (InitStatsRing(&ring, STATS_HISTORY))
+		{
+			hasStats = OpenStatsFile(&statsFile, statsPath);
+			if (hasStats != true)
+				FreeStatsRing(&ring);
+		}
+		if (hasStats)
+		{
+			GetEngineStats(&engine, &stats);
+			PushStats(&ring, &stats);
+		}
+	}
+
+	// The BitBoard is hashed from the tiles it changed, giant boards included, other engines through the bool grid,
+	// Generations rules through all their states like ExecuteSDL : the live cells alone repeat before the board does
+	CycleDetector cycle;
+	bool isBitCycle = type == ENGINE_BITBOARD;
+	uint8_t* States = NULL;
+	bool hasCycle = isStopOnCycle && IsEngineBounded(type) &&
+		InitCycleDetector(&cycle, isBitCycle ? 0 : (int)numCells, false);
+	if (isStopOnCycle && IsEngineBounded(type) != true)
+		printf("--stop-on-cycle needs a bounded engine, %s only shows a window of the plane\n", GetEngineName(type));
+	if (hasCycle && isBitCycle != true && GetRule().numStates > 2)
+	{
+		States = (uint8_t*)malloc(numCells);
+		if (States == NULL)
+		{
+			printf("States malloc fail\n");
+			FreeCycleDetector(&cycle);
+			hasCycle = false;
+		}
+	}
+	if (hasCycle && isBitCycle)
+		ResetCycleDetectorBitBoard(&cycle, &engine.bitBoard);
+	else if (hasCycle && States != NULL)
+	{
+		StoreEngineStates(&engine, States);
+		ResetCycleDetector(&cycle, States);
+	}
+	else if (hasCycle)
+	{
+		StoreEngine(&engine, Cells);
+		ResetCycleDetector(&cycle, (const uint8_t*)Cells);
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	unsigned long long numRun = 0;
+	bool isStepFail = false;
+	while (numRun + (1ULL << stepLog2) <= generations)
+	{
+		if (StepEngine(&engine) != true)
+		{
+			isStepFail = true;
+			break;
+		}
+		numRun += 1ULL << stepLog2;
+		if (hasStats)
+		{
+			GetEngineStats(&engine, &stats);
+			PushStats(&ring, &stats);
+			if (IsStatsRingFull(&ring))
+				WriteStatsFile(&statsFile, &ring);
+		}
+		if (hasCycle && isBitCycle)
+		{
+			if (UpdateCycleDetectorBitBoard(&cycle, &engine.bitBoard) > 0)
+				break;
+		}
+		else if (hasCycle && States != NULL)
+		{
+			StoreEngineStates(&engine, States);
+			if (UpdateCycleDetector(&cycle, States) > 0)
+				break;
+		}
+		else if (hasCycle)
+		{
+			StoreEngine(&engine, Cells);
+			if (UpdateCycleDetector(&cycle, (const uint8_t*)Cells) > 0)
+				break;
+		}
+	}
+	auto stop = std::chrono::steady_clock::now();
+	double seconds = std::chrono::duration<double>(stop - start).count();
+	if (isStepFail)
+		printf("Step fail at generation %llu\n", (unsigned long long)engine.generation);
+
+	uint64_t population = 0;
+	if (isGiant)
+		GetEnginePopulation(&engine, &population);
+	else
+	{
+		StoreEngine(&engine, Cells);
+		population = CountPopulation(Cells, numCells);
+	}
+	double gensPerSec = seconds > 0.0 ? numRun / seconds : 0.0;
+	printf("%llu generations in %.3f s : %.1f gens/sec, %.1f Mcells/sec\n", numRun, seconds, gensPerSec,
+		gensPerSec * numCells / 1e6);
+	printf("Generation %llu, population %llu\n", (unsigned long long)engine.generation, (unsigned long long)population);
+	if (type == ENGINE_BITBOARD && engine.bitBoard.isReserved)
+	{
+		printf("Committed %.1f MB, peak %.1f MB of %.1f MB reserved\n",
+			GetBitBoardCommittedBytes(&engine.bitBoard, false) / 1e6, GetBitBoardCommittedBytes(&engine.bitBoard, true) / 1e6,
+			(double)engine.bitBoard.stride * numYCells * sizeof(uint64_t) * 2 / 1e6);
+	}
+	if (hasStats)
+	{
+		printf("Births %llu, deaths %llu, bounding box (%d, %d) - (%d, %d), stats written to %s\n",
+			(unsigned long long)stats.births, (unsigned long long)stats.deaths, stats.xMin, stats.yMin, stats.xMax, stats.yMax,
+			statsPath);
+		WriteStatsFile(&statsFile, &ring);
+		CloseStatsFile(&statsFile);
+		FreeStatsRing(&ring);
+	}
+	if (hasCycle)
+	{
+		// The detector counts steps : with steps of K generations the period is a multiple of K, the start a step
+		if (cycle.period > 0)
+			printf("Cycle : period %llu from generation %llu\n", (unsigned long long)cycle.period << stepLog2,
+				(unsigned long long)cycle.cycleStart << stepLog2);
+		FreeCycleDetector(&cycle);
+	}
+
+	FreeEngine(&engine);
+	FreeThreadPool(&pool);
+	free(Cells);
+	free(States);
+
+	return isStepFail ? -1 : 0;
+}
@@ -0,0 +1,415 @@
+#include "LifeEngine.h"
+#include "ByteGrid.h"
+#include "Memory.h"
+#include "Rule.h"
+#include <stdio.h>
+#include <string.h>
+
+bool InitEngine(LifeEngine* engine, LifeEngineType type, int numXCells, int numYCells, ThreadPool* pool)
+{
+    memset(engine, 0, sizeof(LifeEngine));
+    engine->type = type;
+    engine->numXCells = numXCells;
+    engine->numYCells = numYCells;
+    engine->pool = pool;
+
+    if (IsEngineSupported(type) != true)
+    {
+        char rulestring[64];
+        FormatRule(GetRule(), rulestring, sizeof(rulestring));
+        printf("InitEngine %s does not run %s\n", GetEngineName(type), rulestring);
+        return false;
+    }
+
+    switch (type)
+    {
+    case ENGINE_BYTEGRID:
+        engine->Cells = (bool*)LifeAlloc((size_t)numXCells * numYCells * sizeof(bool));
+        engine->NextCells = (bool*)LifeAlloc((size_t)numXCells * numYCells * sizeof(bool));
+        if (engine->Cells == NULL || engine->NextCells == NULL ||
+            InitCellTiles(&engine->cellTiles, numXCells, numYCells, pool != NULL ? pool->numThreads : 1) != true)
+        {
+            printf("InitEngine LifeAlloc fail\n");
+            FreeEngine(engine);
+            return false;
+        }
+        memset(engine->Cells, 0, (size_t)numXCells * numYCells * sizeof(bool));
+        memset(engine->NextCells, 0, (size_t)numXCells * numYCells * sizeof(bool));
+        return true;
+    case ENGINE_BITBOARD:
+        return InitBitBoard(&engine->bitBoard, numXCells, numYCells);
+    case ENGINE_HASHLIFE:
+        return InitHashLife(&engine->hashLife);
+    case ENGINE_SPARSE:
+        return InitSparseLife(&engine->sparseLife, numXCells, numYCells);
+    case ENGINE_INCREMENTAL:
+        return InitIncrementalLife(&engine->incrementalLife, numXCells, numYCells);
+    case ENGINE_PADDED:
+        return InitPaddedGrid(&engine->paddedGrid, numXCells, numYCells, NEIGHBOURHOOD_MOORE);
+    case ENGINE_GENERATIONS:
+        return InitGenerations(&engine->generations, numXCells, numYCells, GetRule().numStates);
+    case ENGINE_LARGER_THAN_LIFE:
+        return InitLargerThanLife(&engine->largerThanLife, numXCells, numYCells, pool != NULL ? pool->numThreads : 1);
+    case ENGINE_VON_NEUMANN:
+        return InitPaddedGrid(&engine->paddedGrid, numXCells, numYCells, NEIGHBOURHOOD_VON_NEUMANN);
+    case ENGINE_HEXAGONAL:
+        return InitPaddedGrid(&engine->paddedGrid, numXCells, numYCells, NEIGHBOURHOOD_HEXAGONAL);
+    case ENGINE_CHUNKED:
+        return InitChunkLife(&engine->chunkLife, numXCells, numYCells);
+    default:
+        printf("InitEngine unknown engine %d\n", type);
+        return false;
+    }
+}
+
+void FreeEngine(LifeEngine* engine)
+{
+    switch (engine->type)
+    {
+    case ENGINE_BYTEGRID:
+        LifeFree(engine->Cells);
+        LifeFree(engine->NextCells);
+        FreeCellTiles(&engine->cellTiles);
+        engine->Cells = NULL;
+        engine->NextCells = NULL;
+        break;
+    case ENGINE_BITBOARD:
+        FreeBitBoard(&engine->bitBoard);
+        break;
+    case ENGINE_HASHLIFE:
+        FreeHashLife(&engine->hashLife);
+        break;
+    case ENGINE_SPARSE:
+        FreeSparseLife(&engine->sparseLife);
+        break;
+    case ENGINE_INCREMENTAL:
+        FreeIncrementalLife(&engine->incrementalLife);
+        break;
+    case ENGINE_PADDED:
+    case ENGINE_VON_NEUMANN:
+    case ENGINE_HEXAGONAL:
+        FreePaddedGrid(&engine->paddedGrid);
+        break;
+    case ENGINE_GENERATIONS:
+        FreeGenerations(&engine->generations);
+        break;
+    case ENGINE_LARGER_THAN_LIFE:
+        FreeLargerThanLife(&engine->largerThanLife);
+        break;
+    case ENGINE_CHUNKED:
+        FreeChunkLife(&engine->chunkLife);
+        break;
+    default:
+        break;
+    }
+}
+
+bool StepEngine(LifeEngine* engine)
+{
+    bool isStepped = false;
+
+    switch (engine->type)
+    {
+    case ENGINE_BYTEGRID:
+    {
+        if (engine->cellTiles.stepLog2 > 0)
+            isStepped = UpdateCellTiles(&engine->cellTiles, engine->Cells, engine->NextCells, engine->pool);
+        else
+            isStepped = UpdateCell(engine->Cells, engine->NextCells, engine->numXCells, engine->numYCells, engine->pool);
+        bool* tmpCells = engine->Cells;
+        engine->Cells = engine->NextCells;
+        engine->NextCells = tmpCells;
+        break;
+    }
+    case ENGINE_BITBOARD:
+        isStepped = UpdateBitBoard(&engine->bitBoard, engine->pool);
+        break;
+    case ENGINE_HASHLIFE:
+        isStepped = StepHashLife(&engine->hashLife);
+        break;
+    case ENGINE_SPARSE:
+        isStepped = UpdateSparseLife(&engine->sparseLife);
+        break;
+    case ENGINE_INCREMENTAL:
+        isStepped = UpdateIncrementalLife(&engine->incrementalLife);
+        break;
+    case ENGINE_PADDED:
+    case ENGINE_VON_NEUMANN:
+    case ENGINE_HEXAGONAL:
+        isStepped = UpdatePaddedGrid(&engine->paddedGrid, engine->pool);
+        break;
+    case ENGINE_GENERATIONS:
+        isStepped = UpdateGenerations(&engine->generations, engine->pool);
+        break;
+    case ENGINE_LARGER_THAN_LIFE:
+        isStepped = UpdateLargerThanLife(&engine->largerThanLife, engine->pool);
+        break;
+    case ENGINE_CHUNKED:
+        isStepped = UpdateChunkLife(&engine->chunkLife, engine->pool);
+        break;
+    default:
+        break;
+    }
+
+    if (isStepped)
+        engine->generation += 1ULL << GetEngineStep(engine);
+    return isStepped;
+}
+
+// Any number of generations, HashLife jumps there in O(log generations) steps
+bool AdvanceEngine(LifeEngine* engine, uint64_t generations)
+{
+    if (engine->type == ENGINE_HASHLIFE)
+    {
+        if (AdvanceHashLife(&engine->hashLife, generations) != true)
+            return false;
+        engine->generation += generations;
+        return true;
+    }
+
+    // Single generations, the step of the caller is restored whether they all run or not
+    int stepLog2 = GetEngineStep(engine);
+    SetEngineStep(engine, 0);
+    bool isAdvanced = true;
+    for (uint64_t gen = 0; gen < generations && isAdvanced; gen++)
+    {
+        isAdvanced = StepEngine(engine);
+    }
+    SetEngineStep(engine, stepLog2);
+
+    return isAdvanced;
+}
+
+void LoadEngine(LifeEngine* engine, const bool* Cells)
+{
+    switch (engine->type)
+    {
+    case ENGINE_BYTEGRID:
+        memcpy(engine->Cells, Cells, (size_t)engine->numXCells * engine->numYCells * sizeof(bool));
+        break;
+    case ENGINE_BITBOARD:
+        LoadBitBoard(&engine->bitBoard, Cells);
+        break;
+    case ENGINE_HASHLIFE:
+        LoadHashLife(&engine->hashLife, Cells, engine->numXCells, engine->numYCells);
+        break;
+    case ENGINE_SPARSE:
+        LoadSparseLife(&engine->sparseLife, Cells);
+        break;
+    case ENGINE_INCREMENTAL:
+        LoadIncrementalLife(&engine->incrementalLife, Cells);
+        break;
+    case ENGINE_PADDED:
+    case ENGINE_VON_NEUMANN:
+    case ENGINE_HEXAGONAL:
+        LoadPaddedGrid(&engine->paddedGrid, Cells);
+        break;
+    case ENGINE_GENERATIONS:
+        LoadGenerations(&engine->generations, Cells);
+        break;
+    case ENGINE_LARGER_THAN_LIFE:
+        LoadLargerThanLife(&engine->largerThanLife, Cells);
+        break;
+    case ENGINE_CHUNKED:
+        LoadChunkLife(&engine->chunkLife, Cells);
+        break;
+    default:
+        break;
+    }
+}
+
+void StoreEngine(const LifeEngine* engine, bool* Cells)
+{
+    switch (engine->type)
+    {
+    case ENGINE_BYTEGRID:
+        memcpy(Cells, engine->Cells, (size_t)engine->numXCells * engine->numYCells * sizeof(bool));
+        break;
+    case ENGINE_BITBOARD:
+        StoreBitBoard(&engine->bitBoard, Cells);
+        break;
+    case ENGINE_HASHLIFE:
+        StoreHashLife(&engine->hashLife, Cells, engine->numXCells, engine->numYCells);
+        break;
+    case ENGINE_SPARSE:
+        StoreSparseLife(&engine->sparseLife, Cells);
+        break;
+    case ENGINE_INCREMENTAL:
+        StoreIncrementalLife(&engine->incrementalLife, Cells);
+        break;
+    case ENGINE_PADDED:
+    case ENGINE_VON_NEUMANN:
+    case ENGINE_HEXAGONAL:
+        StorePaddedGrid(&engine->paddedGrid, Cells);
+        break;
+    case ENGINE_GENERATIONS:
+        StoreGenerations(&engine->generations, Cells);
+        break;
+    case ENGINE_LARGER_THAN_LIFE:
+        StoreLargerThanLife(&engine->largerThanLife, Cells);
+        break;
+    case ENGINE_CHUNKED:
+        StoreChunkLife(&engine->chunkLife, Cells);
+        break;
+    default:
+        break;
+    }
+}
+
+// Cell states 0 .. numStates - 1, engines other than ENGINE_GENERATIONS only hold states 0 and 1
+bool LoadEngineStates(LifeEngine* engine, const uint8_t* States)
+{
+    if (engine->type != ENGINE_GENERATIONS)
+    {
+        printf("LoadEngineStates %s fail\n", GetEngineName(engine->type));
+        return false;
+    }
+
+    LoadGenerationsStates(&engine->generations, States);
+    return true;
+}
+
+bool StoreEngineStates(const LifeEngine* engine, uint8_t* States)
+{
+    if (engine->type != ENGINE_GENERATIONS)
+    {
+        printf("StoreEngineStates %s fail\n", GetEngineName(engine->type));
+        return false;
+    }
+
+    StoreGenerationsStates(&engine->generations, States);
+    return true;
+}
+
+const char* GetEngineName(LifeEngineType type)
+{
+    switch (type)
+    {
+    case ENGINE_BYTEGRID:
+        return "Byte Grid";
+    case ENGINE_BITBOARD:
+        return "BitBoard";
+    case ENGINE_HASHLIFE:
+        return "HashLife";
+    case ENGINE_SPARSE:
+        return "Sparse List";
+    case ENGINE_INCREMENTAL:
+        return "Incremental";
+    case ENGINE_PADDED:
+        return "Padded Grid";
+    case ENGINE_GENERATIONS:
+        return "Generations";
+    case ENGINE_LARGER_THAN_LIFE:
+        return "Larger than Life";
+    case ENGINE_VON_NEUMANN:
+        return "von Neumann Grid";
+    case ENGINE_HEXAGONAL:
+        return "Hex Grid";
+    case ENGINE_CHUNKED:
+        return "Chunked Plane";
+    default:
+        return "Unknown";
+    }
+}
+
+bool IsEngineBounded(LifeEngineType type)
+{
+    return type != ENGINE_HASHLIFE && type != ENGINE_CHUNKED;
+}
+
+// Rules with more than two states only run on ENGINE_GENERATIONS, range-R rules on ENGINE_LARGER_THAN_LIFE,
+// rules in Hensel notation on the engines that look up whole neighbourhoods,
+// von Neumann and hexagonal rules on the byte grid and the padded grid of their shape
+bool IsEngineSupported(LifeEngineType type)
+{
+    Rule rule = GetRule();
+    if (rule.hasRange)
+        return type == ENGINE_LARGER_THAN_LIFE;
+    if (type == ENGINE_VON_NEUMANN)
+        return rule.neighbourhood == NEIGHBOURHOOD_VON_NEUMANN;
+    if (type == ENGINE_HEXAGONAL)
+        return rule.neighbourhood == NEIGHBOURHOOD_HEXAGONAL;
+    if (rule.neighbourhood != NEIGHBOURHOOD_MOORE)
+        return type == ENGINE_BYTEGRID;
+    if (rule.isIsotropic)
+        return type == ENGINE_BYTEGRID || type == ENGINE_HASHLIFE;
+    if (rule.numStates > 2)
+        return type == ENGINE_GENERATIONS;
+    return true;
+}
+
+bool SetEngineStats(LifeEngine* engine, bool hasStats)
+{
+    if (engine->type != ENGINE_BITBOARD)
+        return hasStats != true;
+
+    SetBitBoardStats(&engine->bitBoard, hasStats);
+    return true;
+}
+
+// Stats of the current generation, false when the engine does not count them
+bool GetEngineStats(const LifeEngine* engine, LifeStats* stats)
+{
+    if (engine->type != ENGINE_BITBOARD || engine->bitBoard.hasStats != true)
+        return false;
+
+    GetBitBoardStats(&engine->bitBoard, stats);
+    stats->generation = engine->generation;
+    return true;
+}
+
+bool SetEngineCell(LifeEngine* engine, int xidx, int yidx, bool live)
+{
+    if (engine->type != ENGINE_BITBOARD)
+        return false;
+
+    SetBitBoardCell(&engine->bitBoard, xidx, yidx, live);
+    return true;
+}
+
+bool GetEnginePopulation(const LifeEngine* engine, uint64_t* population)
+{
+    if (engine->type != ENGINE_BITBOARD)
+        return false;
+
+    *population = GetBitBoardPopulation(&engine->bitBoard);
+    return true;
+}
+
+bool SetEngineStep(LifeEngine* engine, int stepLog2)
+{
+    if (engine->type == ENGINE_BYTEGRID)
+        return SetCellTilesStep(&engine->cellTiles, stepLog2);
+    if (engine->type != ENGINE_HASHLIFE)
+        return stepLog2 == 0;
+
+    SetHashLifeStep(&engine->hashLife, stepLog2);
+    return true;
+}
+
+int GetEngineStep(const LifeEngine* engine)
+{
+    if (engine->type == ENGINE_BYTEGRID)
+        return engine->cellTiles.stepLog2;
+    return engine->type == ENGINE_HASHLIFE ? engine->hashLife.stepLog2 : 0;
+}
+
+
+static bool IsEnginePadded(LifeEngineType type)
+{
+    return type == ENGINE_PADDED || type == ENGINE_VON_NEUMANN || type == ENGINE_HEXAGONAL;
+}
+
+bool SetEngineTopology(LifeEngine* engine, Topology topology)
+{
+    if (IsEnginePadded(engine->type) != true)
+        return topology == TOPOLOGY_CLAMPED;
+
+    SetPaddedGridTopology(&engine->paddedGrid, topology);
+    return true;
+}
+
+Topology GetEngineTopology(const LifeEngine* engine)
+{
+    return IsEnginePadded(engine->type) ? engine->paddedGrid.topology : TOPOLOGY_CLAMPED;
+}
\ No newline at end of file
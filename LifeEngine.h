@@ -0,0 +1,88 @@
+#pragma once
+
+#include "BitBoard.h"
+#include "HashLife.h"
+#include "SparseLife.h"
+#include "ChunkLife.h"
+#include "IncrementalLife.h"
+#include "PaddedGrid.h"
+#include "Generations.h"
+#include "LargerThanLife.h"
+#include "ByteGrid.h"
+
+enum LifeEngineType
+{
+    ENGINE_BYTEGRID,
+    ENGINE_BITBOARD,
+    ENGINE_HASHLIFE,
+    ENGINE_SPARSE,
+    ENGINE_INCREMENTAL,
+    ENGINE_PADDED,
+    ENGINE_GENERATIONS,
+    ENGINE_LARGER_THAN_LIFE,
+    ENGINE_VON_NEUMANN,
+    ENGINE_HEXAGONAL,
+    ENGINE_CHUNKED,
+    NUM_ENGINES
+};
+
+/*
+One simulation engine behind a common interface.
+ExecuteSDL keeps its own bool grid for drawing and editing, and exchanges it with the engine
+through LoadEngine / StoreEngine.
+Bounded engines use the clamped window boundary of CheckRule, unbounded ones run on the infinite
+plane and the bool grid is a window onto it.
+Generations rules need more than two states, only ENGINE_GENERATIONS runs them and exchanges
+the states through LoadEngineStates / StoreEngineStates, the bool grid holds state 1 only.
+Range-R rules only run on ENGINE_LARGER_THAN_LIFE, which also runs the B/S rules, rules in Hensel
+notation only on the byte grid and HashLife.
+Von Neumann and hexagonal B/S rules run on the byte grid and on ENGINE_VON_NEUMANN / ENGINE_HEXAGONAL,
+padded grids whose row kernels are instantiated for the 4 or 6 neighbours.
+*/
+struct LifeEngine
+{
+    LifeEngineType type;
+    int numXCells;
+    int numYCells;
+    ThreadPool* pool;   // NULL runs single threaded
+    uint64_t generation;
+    bool* Cells;        // ENGINE_BYTEGRID, current generation
+    bool* NextCells;    // ENGINE_BYTEGRID, next generation, swapped with Cells
+    CellTiles cellTiles;    // ENGINE_BYTEGRID, temporal blocking of steps above 2^0
+    BitBoard bitBoard;  // ENGINE_BITBOARD
+    HashLife hashLife;  // ENGINE_HASHLIFE
+    SparseLife sparseLife;  // ENGINE_SPARSE
+    IncrementalLife incrementalLife;    // ENGINE_INCREMENTAL
+    PaddedGrid paddedGrid;  // ENGINE_PADDED, ENGINE_VON_NEUMANN, ENGINE_HEXAGONAL
+    Generations generations;    // ENGINE_GENERATIONS
+    LargerThanLife largerThanLife;  // ENGINE_LARGER_THAN_LIFE
+    ChunkLife chunkLife;    // ENGINE_CHUNKED
+};
+
+bool InitEngine(LifeEngine* engine, LifeEngineType type, int numXCells, int numYCells, ThreadPool* pool);
+void FreeEngine(LifeEngine* engine);
+bool StepEngine(LifeEngine* engine);
+bool AdvanceEngine(LifeEngine* engine, uint64_t generations);
+void LoadEngine(LifeEngine* engine, const bool* Cells);
+void StoreEngine(const LifeEngine* engine, bool* Cells);
+bool LoadEngineStates(LifeEngine* engine, const uint8_t* States);
+bool StoreEngineStates(const LifeEngine* engine, uint8_t* States);
+const char* GetEngineName(LifeEngineType type);
+bool IsEngineBounded(LifeEngineType type);
+bool IsEngineSupported(LifeEngineType type);
+
+// Generations per StepEngine as a power of two, HashLife takes any step, the byte grid up to 2^CELL_MAX_STEP_LOG2
+bool SetEngineStep(LifeEngine* engine, int stepLog2);
+int GetEngineStep(const LifeEngine* engine);
+
+// Population, births, deaths and bounding box fused into the step, only the BitBoard counts them
+bool SetEngineStats(LifeEngine* engine, bool hasStats);
+bool GetEngineStats(const LifeEngine* engine, LifeStats* stats);
+
+// Cell edits and population without a bool grid of the whole board, only the BitBoard has them
+bool SetEngineCell(LifeEngine* engine, int xidx, int yidx, bool live);
+bool GetEnginePopulation(const LifeEngine* engine, uint64_t* population);
+
+// Edge topology, only the padded grids run other topologies than TOPOLOGY_CLAMPED
+bool SetEngineTopology(LifeEngine* engine, Topology topology);
+Topology GetEngineTopology(const LifeEngine* engine);
@@ -0,0 +1,126 @@
+#include "LifeStats.h"
+#include "Memory.h"
+#include <string.h>
+
+#define STATS_FILE_VERSION 1
+
+struct StatsFileHeader
+{
+    char magic[4];          // "STAT"
+    uint32_t version;
+    uint32_t recordSize;    // sizeof(LifeStats), records follow up to the end of the file
+    uint32_t reserved;
+};
+
+bool InitStatsRing(StatsRing* ring, int capacity)
+{
+    ring->capacity = capacity;
+    ring->numPushed = 0;
+    ring->numWritten = 0;
+    ring->Entries = (LifeStats*)LifeAlloc((size_t)capacity * sizeof(LifeStats));
+    if (ring->Entries == NULL)
+    {
+        printf("StatsRing LifeAlloc fail\n");
+        return false;
+    }
+    return true;
+}
+
+void FreeStatsRing(StatsRing* ring)
+{
+    LifeFree(ring->Entries);
+    ring->Entries = NULL;
+}
+
+void PushStats(StatsRing* ring, const LifeStats* stats)
+{
+    ring->Entries[ring->numPushed % ring->capacity] = *stats;
+    ring->numPushed++;
+}
+
+// back 0 : the last pushed, NULL once back reaches past the oldest kept
+const LifeStats* GetLastStats(const StatsRing* ring, int back)
+{
+    if (back < 0 || (uint64_t)back >= ring->numPushed || back >= ring->capacity)
+        return NULL;
+    return &ring->Entries[(ring->numPushed - 1 - back) % ring->capacity];
+}
+
+// True once the next push would overwrite an entry WriteStatsFile has not written yet
+bool IsStatsRingFull(const StatsRing* ring)
+{
+    return ring->numPushed - ring->numWritten >= (uint64_t)ring->capacity;
+}
+
+bool OpenStatsFile(StatsFile* statsFile, const char* path)
+{
+    size_t len = strlen(path);
+    statsFile->isCsv = len >= 4 && strcmp(path + len - 4, ".csv") == 0;
+    statsFile->file = fopen(path, statsFile->isCsv ? "w" : "wb");
+    if (statsFile->file == NULL)
+    {
+        printf("OpenStatsFile %s fail\n", path);
+        return false;
+    }
+
+    bool isWritten;
+    if (statsFile->isCsv)
+    {
+        isWritten = fprintf(statsFile->file, "generation,population,births,deaths,xMin,yMin,xMax,yMax\n") > 0;
+    }
+    else
+    {
+        StatsFileHeader header = { { 'S', 'T', 'A', 'T' }, STATS_FILE_VERSION, sizeof(LifeStats), 0 };
+        isWritten = fwrite(&header, sizeof(header), 1, statsFile->file) == 1;
+    }
+    if (isWritten != true)
+    {
+        printf("OpenStatsFile %s fail\n", path);
+        fclose(statsFile->file);
+        statsFile->file = NULL;
+        return false;
+    }
+    return true;
+}
+
+// Writes the entries pushed since the last call, entries the ring already overwrote are lost
+bool WriteStatsFile(StatsFile* statsFile, StatsRing* ring)
+{
+    if (statsFile->file == NULL)
+        return false;
+
+    uint64_t first = ring->numWritten;
+    if (ring->numPushed - first > (uint64_t)ring->capacity)
+        first = ring->numPushed - ring->capacity;
+
+    bool isWritten = true;
+    for (uint64_t idx = first; idx < ring->numPushed && isWritten; idx++)
+    {
+        const LifeStats* stats = &ring->Entries[idx % ring->capacity];
+        if (statsFile->isCsv)
+        {
+            isWritten = fprintf(statsFile->file, "%llu,%llu,%llu,%llu,%d,%d,%d,%d\n",
+                (unsigned long long)stats->generation, (unsigned long long)stats->population,
+                (unsigned long long)stats->births, (unsigned long long)stats->deaths,
+                stats->xMin, stats->yMin, stats->xMax, stats->yMax) > 0;
+        }
+        else
+        {
+            isWritten = fwrite(stats, sizeof(LifeStats), 1, statsFile->file) == 1;
+        }
+    }
+    ring->numWritten = ring->numPushed;
+
+    if (isWritten != true)
+        printf("WriteStatsFile fail\n");
+    return isWritten;
+}
+
+bool CloseStatsFile(StatsFile* statsFile)
+{
+    if (statsFile->file == NULL)
+        return false;
+    bool isClosed = fclose(statsFile->file) == 0;
+    statsFile->file = NULL;
+    return isClosed;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+
+#define STATS_HISTORY 4096      // generations kept in the ring
+
+/*
+Statistics of one generation, births and deaths count the cells that changed since the generation before.
+The bounding box holds the live cells, an empty board has xMin > xMax and yMin > yMax.
+*/
+struct LifeStats
+{
+    uint64_t generation;
+    uint64_t population;
+    uint64_t births;
+    uint64_t deaths;
+    int32_t xMin;
+    int32_t yMin;
+    int32_t xMax;
+    int32_t yMax;
+};
+
+// The stats of the last capacity generations, PushStats overwrites the oldest
+struct StatsRing
+{
+    LifeStats* Entries;
+    int capacity;
+    uint64_t numPushed;
+    uint64_t numWritten;    // pushed entries already written by WriteStatsFile
+};
+
+/*
+Time series of a headless run : CSV with a header line when the path ends in .csv, otherwise
+a "STAT" header (magic, version, record size) and LifeStats records in host byte order.
+*/
+struct StatsFile
+{
+    FILE* file;
+    bool isCsv;
+};
+
+bool InitStatsRing(StatsRing* ring, int capacity);
+void FreeStatsRing(StatsRing* ring);
+void PushStats(StatsRing* ring, const LifeStats* stats);
+const LifeStats* GetLastStats(const StatsRing* ring, int back);
+bool IsStatsRingFull(const StatsRing* ring);
+
+bool OpenStatsFile(StatsFile* statsFile, const char* path);
+bool WriteStatsFile(StatsFile* statsFile, StatsRing* ring);
+bool CloseStatsFile(StatsFile* statsFile);
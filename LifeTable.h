@@ -0,0 +1,57 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+Rule lookup tables for the birth / survival count masks of Rule.h, the B3/S23 ones are generated at compile time.
+LifeTable512 : index bit (3 * column + row) is the cell at (column, row) of a 3x3 neighbourhood,
+the centre is bit 4, the entry is the next state of the centre.
+LifeTable4x4 : index bit (4 * column + row) is the cell at (column, row) of a 4x4 block,
+the entry holds the next state of the inner 2x2 cells, bit (2 * (row - 1) + (column - 1)).
+*/
+constexpr bool LifeRule(int index512, int birth, int survival)
+{
+    // Population count of the 8 neighbour bits
+    int bits = index512 & 0x1EF;
+    bits = (bits & 0x155) + ((bits >> 1) & 0x055);
+    bits = (bits & 0x133) + ((bits >> 2) & 0x033);
+    int numNeighbours = (bits & 0x0F) + ((bits >> 4) & 0x0F) + (bits >> 8);
+    return ((((index512 >> 4) & 1) ? survival : birth) >> numNeighbours) & 1;
+}
+
+struct LifeTable512
+{
+    uint8_t Next[512];
+
+    LifeTable512() = default;
+    constexpr LifeTable512(int birth, int survival) : Next()
+    {
+        for (int index = 0; index < 512; index++)
+        {
+            Next[index] = LifeRule(index, birth, survival);
+        }
+    }
+};
+
+// Built from the 512 table, so any rule that has one (Hensel notation as well) gets the 4x4 table too
+struct LifeTable4x4
+{
+    uint8_t Next[65536];
+
+    LifeTable4x4() = default;
+    constexpr LifeTable4x4(int birth, int survival) : LifeTable4x4(LifeTable512(birth, survival))
+    {
+    }
+    constexpr LifeTable4x4(const LifeTable512& table) : Next()
+    {
+        for (int index = 0; index < 65536; index++)
+        {
+            // Inner cell (column, row) sees rows row-1..row+1 of columns column-1..column+1
+            int west = index & 0xF, centre = (index >> 4) & 0xF, east = (index >> 8) & 0xF, far = index >> 12;
+            Next[index] = (uint8_t)(table.Next[(west & 7) | (centre & 7) << 3 | (east & 7) << 6] |
+                table.Next[(centre & 7) | (east & 7) << 3 | (far & 7) << 6] << 1 |
+                table.Next[(west >> 1) | (centre >> 1) << 3 | (east >> 1) << 6] << 2 |
+                table.Next[(centre >> 1) | (east >> 1) << 3 | (far >> 1) << 6] << 3);
+        }
+    }
+};
@@ -0,0 +1,84 @@
+#include "Memory.h"
+#include <stdlib.h>
+#include <atomic>
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+static std::atomic<uint64_t> AllocCount(0);
+
+void* LifeAlloc(size_t size)
+{
+    AllocCount++;
+
+    size = (size + CACHE_LINE - 1) & ~(size_t)(CACHE_LINE - 1);
+    if (size == 0)
+        size = CACHE_LINE;
+#if defined(_MSC_VER)
+    return _aligned_malloc(size, CACHE_LINE);
+#else
+    return aligned_alloc(CACHE_LINE, size);
+#endif
+}
+
+void LifeFree(void* ptr)
+{
+    if (ptr == NULL)
+        return;
+#if defined(_MSC_VER)
+    _aligned_free(ptr);
+#else
+    free(ptr);
+#endif
+}
+
+uint64_t GetAllocCount()
+{
+    return AllocCount.load();
+}
+
+void* ReserveLifeMemory(size_t size)
+{
+#if defined(_WIN32)
+    return VirtualAlloc(NULL, size, MEM_RESERVE, PAGE_NOACCESS);
+#else
+    void* ptr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    return ptr != MAP_FAILED ? ptr : NULL;
+#endif
+}
+
+bool CommitLifeMemory(void* ptr, size_t size)
+{
+#if defined(_WIN32)
+    return VirtualAlloc(ptr, size, MEM_COMMIT, PAGE_READWRITE) != NULL;
+#else
+    (void)ptr;
+    (void)size;
+    return true;
+#endif
+}
+
+void DecommitLifeMemory(void* ptr, size_t size)
+{
+#if defined(_WIN32)
+    VirtualFree(ptr, size, MEM_DECOMMIT);
+#else
+    madvise(ptr, size, MADV_DONTNEED);
+#endif
+}
+
+void FreeLifeMemory(void* ptr, size_t size)
+{
+    if (ptr == NULL)
+        return;
+#if defined(_WIN32)
+    (void)size;
+    VirtualFree(ptr, 0, MEM_RELEASE);
+#else
+    munmap(ptr, size);
+#endif
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define CACHE_LINE 64
+
+/*
+Cache-line aligned allocation for engine buffers.
+Every call is counted so benchmarks can check that the steady-state loop does not allocate.
+*/
+void* LifeAlloc(size_t size);
+void LifeFree(void* ptr);
+uint64_t GetAllocCount();
+
+/*
+Address space reserved without committing it, for boards too large to hold in memory.
+Pages are zero until first written. On Linux they fault in on first touch and CommitLifeMemory
+does nothing, on Windows a range has to be committed before it is touched.
+DecommitLifeMemory gives the pages back to the OS (madvise MADV_DONTNEED / MEM_DECOMMIT), they read
+as zero once touched again. Ranges are whole pages of LIFE_PAGE_SIZE.
+*/
+#define LIFE_PAGE_SIZE 4096
+
+void* ReserveLifeMemory(size_t size);
+bool CommitLifeMemory(void* ptr, size_t size);
+void DecommitLifeMemory(void* ptr, size_t size);
+void FreeLifeMemory(void* ptr, size_t size);
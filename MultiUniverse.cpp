@@ -0,0 +1,181 @@
+#include "MultiUniverse.h"
+#include "BitSlice.h"
+#include "Memory.h"
+#include <stdio.h>
+#include <string.h>
+
+bool InitMultiUniverse(MultiUniverse* multi, int numXCells, int numYCells)
+{
+    multi->numXCells = numXCells;
+    multi->numYCells = numYCells;
+    multi->stride = numXCells + 2;
+    multi->Front = NULL;
+    multi->Back = NULL;
+
+    Rule rule = GetRule();
+    if (rule.numStates > 2 || rule.hasRange || rule.isIsotropic || rule.neighbourhood != NEIGHBOURHOOD_MOORE)
+    {
+        printf("InitMultiUniverse rule fail\n");
+        return false;
+    }
+
+    size_t size = (size_t)multi->stride * (numYCells + 2) * sizeof(uint64_t);
+    multi->Front = (uint64_t*)LifeAlloc(size);
+    multi->Back = (uint64_t*)LifeAlloc(size);
+    if (multi->Front == NULL || multi->Back == NULL)
+    {
+        printf("MultiUniverse LifeAlloc fail\n");
+        FreeMultiUniverse(multi);
+        return false;
+    }
+    memset(multi->Front, 0, size);
+    memset(multi->Back, 0, size);
+
+    return true;
+}
+
+void FreeMultiUniverse(MultiUniverse* multi)
+{
+    LifeFree(multi->Front);
+    LifeFree(multi->Back);
+    multi->Front = NULL;
+    multi->Back = NULL;
+}
+
+// Same clamped halo as FillHaloClamped of PaddedGrid
+static void FillHalo(MultiUniverse* multi)
+{
+    int stride = multi->stride;
+    int numXCells = multi->numXCells;
+    int numYCells = multi->numYCells;
+    uint64_t* Cells = multi->Front;
+
+    for (int py = 1; py <= numYCells; py++)
+    {
+        uint64_t* row = Cells + (size_t)stride * py;
+        row[0] = row[1];
+        row[numXCells + 1] = row[numXCells];
+    }
+    memcpy(Cells, Cells + stride, stride * sizeof(uint64_t));
+    memcpy(Cells + (size_t)stride * (numYCells + 1), Cells + (size_t)stride * numYCells, stride * sizeof(uint64_t));
+}
+
+// Every word is 64 cells of different universes, the neighbours are the words around it
+template <int Birth, int Survival>
+static void UpdateMultiRow(const uint64_t* __restrict up, const uint64_t* __restrict mid, const uint64_t* __restrict down,
+                           uint64_t* __restrict out, int numXCells, Rule rule)
+{
+    for (int px = 1; px <= numXCells; px++)
+    {
+        out[px] = LifeWord<Birth, Survival>(up[px - 1], up[px], up[px + 1],
+                                            mid[px - 1], mid[px], mid[px + 1],
+                                            down[px - 1], down[px], down[px + 1], rule);
+    }
+}
+
+template <int Birth, int Survival>
+static void UpdateMultiRowsRule(const MultiUniverse* multi, int yBegin, int yEnd)
+{
+    Rule rule = GetRule();
+    int stride = multi->stride;
+    for (int py = yBegin + 1; py <= yEnd; py++)
+    {
+        const uint64_t* mid = multi->Front + (size_t)stride * py;
+        UpdateMultiRow<Birth, Survival>(mid - stride, mid, mid + stride, multi->Back + (size_t)stride * py,
+            multi->numXCells, rule);
+    }
+}
+
+typedef void (*MultiRowsKernel)(const MultiUniverse* multi, int yBegin, int yEnd);
+
+static const MultiRowsKernel MultiRowsKernels[NUM_RULE_KERNELS] =
+{
+    UpdateMultiRowsRule<RULE_RUNTIME, RULE_RUNTIME>,
+    UpdateMultiRowsRule<RULE_B3, RULE_S23>,
+    UpdateMultiRowsRule<RULE_B36, RULE_S23>,
+    UpdateMultiRowsRule<RULE_B3678, RULE_S34678>,
+};
+
+struct MultiBands
+{
+    const MultiUniverse* multi;
+    int numBands;
+};
+
+static void UpdateMultiBand(void* context, int taskIdx, int threadIdx)
+{
+    const MultiBands* bands = (const MultiBands*)context;
+    int yBegin, yEnd;
+
+    GetBandRows(bands->multi->numYCells, 1, bands->numBands, taskIdx, &yBegin, &yEnd);
+    MultiRowsKernels[GetRuleKernel()](bands->multi, yBegin, yEnd);
+}
+
+bool UpdateMultiUniverse(MultiUniverse* multi, ThreadPool* pool)
+{
+    if (multi->Front == NULL || multi->Back == NULL)
+    {
+        printf("UpdateMultiUniverse fail\n");
+        return false;
+    }
+
+    FillHalo(multi);
+    if (pool != NULL && pool->numThreads > 1)
+    {
+        MultiBands bands = { multi, pool->numThreads };
+        RunThreadPool(pool, UpdateMultiBand, &bands, bands.numBands);
+    }
+    else
+    {
+        MultiRowsKernels[GetRuleKernel()](multi, 0, multi->numYCells);
+    }
+
+    uint64_t* tmp = multi->Front;
+    multi->Front = multi->Back;
+    multi->Back = tmp;
+
+    return true;
+}
+
+// Writes one universe, the other 63 lanes keep their cells
+void LoadMultiUniverseLane(MultiUniverse* multi, int lane, const bool* Cells)
+{
+    uint64_t bit = 1ULL << lane;
+    for (int yidx = 0; yidx < multi->numYCells; yidx++)
+    {
+        uint64_t* row = multi->Front + (size_t)multi->stride * (yidx + 1) + 1;
+        const bool* src = Cells + (size_t)multi->numXCells * yidx;
+        for (int xidx = 0; xidx < multi->numXCells; xidx++)
+        {
+            row[xidx] = (row[xidx] & ~bit) | ((uint64_t)src[xidx] << lane);
+        }
+    }
+}
+
+void StoreMultiUniverseLane(const MultiUniverse* multi, int lane, bool* Cells)
+{
+    for (int yidx = 0; yidx < multi->numYCells; yidx++)
+    {
+        const uint64_t* row = multi->Front + (size_t)multi->stride * (yidx + 1) + 1;
+        bool* dst = Cells + (size_t)multi->numXCells * yidx;
+        for (int xidx = 0; xidx < multi->numXCells; xidx++)
+        {
+            dst[xidx] = (row[xidx] >> lane) & 1;
+        }
+    }
+}
+
+// Bit l is set while universe l has any live cell, a soup that died out drops its bit
+uint64_t GetMultiUniverseLiveLanes(const MultiUniverse* multi)
+{
+    uint64_t live = 0;
+    for (int yidx = 0; yidx < multi->numYCells; yidx++)
+    {
+        const uint64_t* row = multi->Front + (size_t)multi->stride * (yidx + 1) + 1;
+        for (int xidx = 0; xidx < multi->numXCells; xidx++)
+        {
+            live |= row[xidx];
+        }
+    }
+    return live;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stdint.h>
+#include "ThreadPool.h"
+
+#define MULTI_UNIVERSE_LANES 64
+
+/*
+64 independent boards of the same size evolved together : bit l of the word of a cell is that cell in
+universe l, so the full adders of LifeWord run all 64 universes with one word per neighbour and no shifts.
+The grid has a one cell halo ring like PaddedGrid, (x, y) is at (x + 1) + stride * (y + 1), refreshed
+every generation with the edge cells (Window Boundary Rule of CheckRule).
+Only totalistic Moore B/S rules of two states run on it.
+*/
+struct MultiUniverse
+{
+    int numXCells;
+    int numYCells;
+    int stride;         // numXCells + 2
+    uint64_t* Front;    // current generation including the halo
+    uint64_t* Back;     // next generation, swapped with Front
+};
+
+bool InitMultiUniverse(MultiUniverse* multi, int numXCells, int numYCells);
+void FreeMultiUniverse(MultiUniverse* multi);
+bool UpdateMultiUniverse(MultiUniverse* multi, ThreadPool* pool);
+
+void LoadMultiUniverseLane(MultiUniverse* multi, int lane, const bool* Cells);
+void StoreMultiUniverseLane(const MultiUniverse* multi, int lane, bool* Cells);
+uint64_t GetMultiUniverseLiveLanes(const MultiUniverse* multi);
@@ -0,0 +1,292 @@
+#include "PaddedGrid.h"
+#include "Memory.h"
+#include "Rule.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+bool InitPaddedGrid(PaddedGrid* grid, int numXCells, int numYCells, Neighbourhood shape)
+{
+    grid->numXCells = numXCells;
+    grid->numYCells = numYCells;
+    grid->stride = numXCells + 2;
+    grid->topology = TOPOLOGY_CLAMPED;
+    grid->shape = shape;
+    grid->Front = NULL;
+    grid->Back = NULL;
+    if (shape < 0 || shape >= NUM_NEIGHBOURHOODS)
+    {
+        printf("InitPaddedGrid neighbourhood %d fail\n", shape);
+        return false;
+    }
+
+    size_t size = (size_t)grid->stride * (numYCells + 2) * sizeof(bool);
+    grid->Front = (bool*)LifeAlloc(size);
+    grid->Back = (bool*)LifeAlloc(size);
+    if (grid->Front == NULL || grid->Back == NULL)
+    {
+        printf("PaddedGrid LifeAlloc fail\n");
+        FreePaddedGrid(grid);
+        return false;
+    }
+    memset(grid->Front, 0, size);
+    memset(grid->Back, 0, size);
+
+    return true;
+}
+
+void FreePaddedGrid(PaddedGrid* grid)
+{
+    LifeFree(grid->Front);
+    LifeFree(grid->Back);
+    grid->Front = NULL;
+    grid->Back = NULL;
+}
+
+/*
+Halo fills : the left and right halo columns of the inner rows first, then the top and bottom halo rows
+are copied from whole padded rows, so the corners come with them.
+*/
+static void FillHaloClamped(PaddedGrid* grid)
+{
+    int stride = grid->stride;
+    int numXCells = grid->numXCells;
+    int numYCells = grid->numYCells;
+    bool* Cells = grid->Front;
+
+    for (int py = 1; py <= numYCells; py++)
+    {
+        bool* row = Cells + (size_t)stride * py;
+        row[0] = row[1];
+        row[numXCells + 1] = row[numXCells];
+    }
+    memcpy(Cells, Cells + stride, stride * sizeof(bool));
+    memcpy(Cells + (size_t)stride * (numYCells + 1), Cells + (size_t)stride * numYCells, stride * sizeof(bool));
+}
+
+static void FillHaloDead(PaddedGrid* grid)
+{
+    int stride = grid->stride;
+    int numXCells = grid->numXCells;
+    int numYCells = grid->numYCells;
+    bool* Cells = grid->Front;
+
+    for (int py = 1; py <= numYCells; py++)
+    {
+        bool* row = Cells + (size_t)stride * py;
+        row[0] = false;
+        row[numXCells + 1] = false;
+    }
+    memset(Cells, 0, stride * sizeof(bool));
+    memset(Cells + (size_t)stride * (numYCells + 1), 0, stride * sizeof(bool));
+}
+
+static void FillHaloTorus(PaddedGrid* grid)
+{
+    int stride = grid->stride;
+    int numXCells = grid->numXCells;
+    int numYCells = grid->numYCells;
+    bool* Cells = grid->Front;
+
+    for (int py = 1; py <= numYCells; py++)
+    {
+        bool* row = Cells + (size_t)stride * py;
+        row[0] = row[numXCells];
+        row[numXCells + 1] = row[1];
+    }
+    memcpy(Cells, Cells + (size_t)stride * numYCells, stride * sizeof(bool));
+    memcpy(Cells + (size_t)stride * (numYCells + 1), Cells + stride, stride * sizeof(bool));
+}
+
+// Crossing the top or bottom edge mirrors x, padded column px of a halo row is column stride - 1 - px
+static void FillHaloKlein(PaddedGrid* grid)
+{
+    int stride = grid->stride;
+    int numXCells = grid->numXCells;
+    int numYCells = grid->numYCells;
+    bool* Cells = grid->Front;
+
+    for (int py = 1; py <= numYCells; py++)
+    {
+        bool* row = Cells + (size_t)stride * py;
+        row[0] = row[numXCells];
+        row[numXCells + 1] = row[1];
+    }
+    const bool* first = Cells + stride;
+    const bool* last = Cells + (size_t)stride * numYCells;
+    bool* top = Cells;
+    bool* bottom = Cells + (size_t)stride * (numYCells + 1);
+    for (int px = 0; px < stride; px++)
+    {
+        top[px] = last[stride - 1 - px];
+        bottom[px] = first[stride - 1 - px];
+    }
+}
+
+typedef void (*HaloFill)(PaddedGrid* grid);
+
+static const HaloFill HaloFills[NUM_TOPOLOGIES] = { FillHaloClamped, FillHaloDead, FillHaloTorus, FillHaloKlein };
+
+/*
+Live neighbours of padded column px, Shape is a constant so every instantiation keeps only its own sum.
+Hexagonal : even rows (Offset 0) touch columns px - 1 and px of the rows above and below,
+odd rows (Offset 1) columns px and px + 1.
+*/
+template <Neighbourhood Shape, int Offset>
+static inline uint8_t CountNeighbours(const uint8_t* __restrict up, const uint8_t* __restrict mid,
+                                      const uint8_t* __restrict down, int px)
+{
+    switch (Shape)
+    {
+    case NEIGHBOURHOOD_VON_NEUMANN:
+        return up[px] + mid[px - 1] + mid[px + 1] + down[px];
+    case NEIGHBOURHOOD_HEXAGONAL:
+        return up[px - 1 + Offset] + up[px + Offset] +
+            mid[px - 1] + mid[px + 1] +
+            down[px - 1 + Offset] + down[px + Offset];
+    default:
+        return up[px - 1] + up[px] + up[px + 1] +
+            mid[px - 1] + mid[px + 1] +
+            down[px - 1] + down[px] + down[px + 1];
+    }
+}
+
+// No boundary check in the loop and no aliasing between the rows, the compiler vectorizes it with byte sums
+template <Neighbourhood Shape, int Offset, int Birth, int Survival>
+static void UpdatePaddedRow(const uint8_t* __restrict up, const uint8_t* __restrict mid, const uint8_t* __restrict down,
+                            uint8_t* __restrict out, int numXCells, Rule rule)
+{
+    for (int px = 1; px <= numXCells; px++)
+    {
+        uint8_t numNeighbours = CountNeighbours<Shape, Offset>(up, mid, down, px);
+        out[px] = RuleCell<Birth, Survival>(numNeighbours, mid[px], rule);
+    }
+}
+
+// Padded row py is cell row py - 1, so odd padded rows are the even rows of the hex grid
+template <Neighbourhood Shape, int Birth, int Survival>
+static void UpdatePaddedRowsRule(const PaddedGrid* grid, int yBegin, int yEnd)
+{
+    Rule rule = GetRule();
+    int stride = grid->stride;
+    for (int py = yBegin + 1; py <= yEnd; py++)
+    {
+        const uint8_t* mid = (const uint8_t*)grid->Front + (size_t)stride * py;
+        uint8_t* out = (uint8_t*)grid->Back + (size_t)stride * py;
+        if (Shape == NEIGHBOURHOOD_HEXAGONAL && (py & 1) == 0)
+            UpdatePaddedRow<Shape, 1, Birth, Survival>(mid - stride, mid, mid + stride, out, grid->numXCells, rule);
+        else
+            UpdatePaddedRow<Shape, 0, Birth, Survival>(mid - stride, mid, mid + stride, out, grid->numXCells, rule);
+    }
+}
+
+typedef void (*PaddedRowsKernel)(const PaddedGrid* grid, int yBegin, int yEnd);
+
+// SetRule only gives the specialized rule kernels to Moore rules, the other shapes read the masks
+static const PaddedRowsKernel PaddedRowsKernels[NUM_NEIGHBOURHOODS][NUM_RULE_KERNELS] =
+{
+    {
+        UpdatePaddedRowsRule<NEIGHBOURHOOD_MOORE, RULE_RUNTIME, RULE_RUNTIME>,
+        UpdatePaddedRowsRule<NEIGHBOURHOOD_MOORE, RULE_B3, RULE_S23>,
+        UpdatePaddedRowsRule<NEIGHBOURHOOD_MOORE, RULE_B36, RULE_S23>,
+        UpdatePaddedRowsRule<NEIGHBOURHOOD_MOORE, RULE_B3678, RULE_S34678>,
+    },
+    {
+        UpdatePaddedRowsRule<NEIGHBOURHOOD_VON_NEUMANN, RULE_RUNTIME, RULE_RUNTIME>,
+        UpdatePaddedRowsRule<NEIGHBOURHOOD_VON_NEUMANN, RULE_RUNTIME, RULE_RUNTIME>,
+        UpdatePaddedRowsRule<NEIGHBOURHOOD_VON_NEUMANN, RULE_RUNTIME, RULE_RUNTIME>,
+        UpdatePaddedRowsRule<NEIGHBOURHOOD_VON_NEUMANN, RULE_RUNTIME, RULE_RUNTIME>,
+    },
+    {
+        UpdatePaddedRowsRule<NEIGHBOURHOOD_HEXAGONAL, RULE_RUNTIME, RULE_RUNTIME>,
+        UpdatePaddedRowsRule<NEIGHBOURHOOD_HEXAGONAL, RULE_RUNTIME, RULE_RUNTIME>,
+        UpdatePaddedRowsRule<NEIGHBOURHOOD_HEXAGONAL, RULE_RUNTIME, RULE_RUNTIME>,
+        UpdatePaddedRowsRule<NEIGHBOURHOOD_HEXAGONAL, RULE_RUNTIME, RULE_RUNTIME>,
+    },
+};
+
+static void UpdatePaddedRows(const PaddedGrid* grid, int yBegin, int yEnd)
+{
+    PaddedRowsKernels[grid->shape][GetRuleKernel()](grid, yBegin, yEnd);
+}
+
+struct PaddedBands
+{
+    const PaddedGrid* grid;
+    int numBands;
+};
+
+static void UpdatePaddedBand(void* context, int taskIdx, int threadIdx)
+{
+    const PaddedBands* bands = (const PaddedBands*)context;
+    int yBegin, yEnd;
+
+    GetBandRows(bands->grid->numYCells, 1, bands->numBands, taskIdx, &yBegin, &yEnd);
+    UpdatePaddedRows(bands->grid, yBegin, yEnd);
+}
+
+bool UpdatePaddedGrid(PaddedGrid* grid, ThreadPool* pool)
+{
+    if (grid->Front == NULL || grid->Back == NULL)
+    {
+        printf("UpdatePaddedGrid fail\n");
+        return false;
+    }
+
+    HaloFills[grid->topology](grid);
+    if (pool != NULL && pool->numThreads > 1)
+    {
+        PaddedBands bands = { grid, pool->numThreads };
+        RunThreadPool(pool, UpdatePaddedBand, &bands, bands.numBands);
+    }
+    else
+    {
+        UpdatePaddedRows(grid, 0, grid->numYCells);
+    }
+
+    bool* tmp = grid->Front;
+    grid->Front = grid->Back;
+    grid->Back = tmp;
+
+    return true;
+}
+
+void SetPaddedGridTopology(PaddedGrid* grid, Topology topology)
+{
+    grid->topology = topology;
+}
+
+const char* GetTopologyName(Topology topology)
+{
+    switch (topology)
+    {
+    case TOPOLOGY_CLAMPED:
+        return "Clamped";
+    case TOPOLOGY_DEAD:
+        return "Dead Border";
+    case TOPOLOGY_TORUS:
+        return "Torus";
+    case TOPOLOGY_KLEIN:
+        return "Klein Bottle";
+    default:
+        return "Unknown";
+    }
+}
+
+void LoadPaddedGrid(PaddedGrid* grid, const bool* Cells)
+{
+    for (int yidx = 0; yidx < grid->numYCells; yidx++)
+    {
+        memcpy(grid->Front + (size_t)grid->stride * (yidx + 1) + 1, Cells + (size_t)grid->numXCells * yidx,
+            grid->numXCells * sizeof(bool));
+    }
+}
+
+void StorePaddedGrid(const PaddedGrid* grid, bool* Cells)
+{
+    for (int yidx = 0; yidx < grid->numYCells; yidx++)
+    {
+        memcpy(Cells + (size_t)grid->numXCells * yidx, grid->Front + (size_t)grid->stride * (yidx + 1) + 1,
+            grid->numXCells * sizeof(bool));
+    }
+}
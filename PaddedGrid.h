@@ -0,0 +1,42 @@
+#pragma once
+
+#include "ThreadPool.h"
+#include "Rule.h"
+
+enum Topology
+{
+    TOPOLOGY_CLAMPED,   // Window Boundary Rule of CheckRule, the cell beyond the edge is the edge cell
+    TOPOLOGY_DEAD,      // cells beyond the edge are dead
+    TOPOLOGY_TORUS,     // left meets right, top meets bottom
+    TOPOLOGY_KLEIN,     // left meets right, top meets bottom mirrored left to right
+    NUM_TOPOLOGIES
+};
+
+/*
+Byte grid with a one cell halo ring : (numXCells + 2) x (numYCells + 2) cells, cell (x, y) is at
+(x + 1) + stride * (y + 1). The halo is refreshed once per generation by the fill of the topology,
+so the inner kernel reads its neighbours without any boundary check.
+The row kernels are instantiated per neighbourhood shape, a grid runs the one it was created for :
+Moore counts 8 neighbours, von Neumann the 4 orthogonal ones and hexagonal the 6 of a hex grid in offset
+rows, where odd rows sit half a cell to the right of even rows. The torus keeps the offset rows of a hex
+grid only for an even number of rows.
+*/
+struct PaddedGrid
+{
+    int numXCells;
+    int numYCells;
+    int stride;         // numXCells + 2
+    Topology topology;
+    Neighbourhood shape;
+    bool* Front;        // current generation including the halo
+    bool* Back;         // next generation, swapped with Front
+};
+
+bool InitPaddedGrid(PaddedGrid* grid, int numXCells, int numYCells, Neighbourhood shape);
+void FreePaddedGrid(PaddedGrid* grid);
+bool UpdatePaddedGrid(PaddedGrid* grid, ThreadPool* pool);
+void SetPaddedGridTopology(PaddedGrid* grid, Topology topology);
+const char* GetTopologyName(Topology topology);
+
+void LoadPaddedGrid(PaddedGrid* grid, const bool* Cells);
+void StorePaddedGrid(const PaddedGrid* grid, bool* Cells);
@@ -0,0 +1,219 @@
+#include "Pattern.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <vector>
+
+struct PatternCell
+{
+    int x;
+    int y;
+};
+
+static char* ReadPatternFile(const char* path)
+{
+    FILE* file = fopen(path, "rb");
+    if (file == NULL)
+        return NULL;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    char* Text = size >= 0 ? (char*)malloc(size + 1) : NULL;
+    if (Text != NULL)
+    {
+        size_t numRead = fread(Text, 1, size, file);
+        Text[numRead] = '\0';
+    }
+    fclose(file);
+    return Text;
+}
+
+static const char* SkipLine(const char* c)
+{
+    while (*c != '\0' && *c != '\n')
+        c++;
+    return *c == '\n' ? c + 1 : c;
+}
+
+// "rule = B3/S23" of the header line, up to the end of the line
+static void ReadRleRule(const char* line, char* rule, int ruleSize)
+{
+    const char* found = strstr(line, "rule");
+    const char* end = SkipLine(line);
+    if (found == NULL || found >= end || rule == NULL)
+        return;
+    found += 4;
+    while (*found == ' ' || *found == '=')
+        found++;
+    int len = 0;
+    while (found + len < end && found[len] != '\r' && found[len] != '\n' && len < ruleSize - 1)
+    {
+        rule[len] = found[len];
+        len++;
+    }
+    while (len > 0 && rule[len - 1] == ' ')
+        len--;
+    rule[len] = '\0';
+}
+
+static bool IsRleText(const char* Text)
+{
+    const char* c = Text;
+    while (*c == '#')
+        c = SkipLine(c);
+    while (*c == ' ')
+        c++;
+    return *c == 'x';
+}
+
+static bool ParseRle(const char* Text, std::vector<PatternCell>& Live, char* rule, int ruleSize)
+{
+    const char* c = Text;
+    while (*c == '#')
+        c = SkipLine(c);
+    ReadRleRule(c, rule, ruleSize);
+    c = SkipLine(c);
+
+    int x = 0, y = 0;
+    int count = 0;
+    for (; *c != '\0' && *c != '!'; c++)
+    {
+        if (isdigit((unsigned char)*c))
+        {
+            count = count * 10 + (*c - '0');
+            continue;
+        }
+        if (isspace((unsigned char)*c))
+            continue;
+
+        int run = count > 0 ? count : 1;
+        count = 0;
+        if (*c == '$')
+        {
+            y += run;
+            x = 0;
+        }
+        else if (*c == 'b' || *c == '.')
+        {
+            x += run;
+        }
+        else if (*c == 'o' || (*c >= 'A' && *c <= 'X') || (*c >= 'p' && *c <= 'y' && c[1] >= 'A' && c[1] <= 'X'))
+        {
+            // Every state other than 0 is live, p..y prefix the states from 25 on
+            if (*c >= 'p' && *c <= 'y')
+                c++;
+            for (int i = 0; i < run; i++)
+                Live.push_back({ x + i, y });
+            x += run;
+        }
+        else
+        {
+            printf("LoadPattern RLE '%c' fail\n", *c);
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool ParsePlaintext(const char* Text, std::vector<PatternCell>& Live)
+{
+    const char* c = Text;
+    int y = 0;
+    while (*c != '\0')
+    {
+        if (*c == '!')
+        {
+            c = SkipLine(c);
+            continue;
+        }
+        int x = 0;
+        for (; *c != '\0' && *c != '\n'; c++, x++)
+        {
+            if (*c == 'O' || *c == '*')
+                Live.push_back({ x, y });
+            else if (*c != '.' && *c != '\r' && *c != ' ')
+            {
+                printf("LoadPattern plaintext '%c' fail\n", *c);
+                return false;
+            }
+        }
+        if (*c == '\n')
+            c++;
+        y++;
+    }
+    return true;
+}
+
+int* LoadPatternCells(const char* path, int numXCells, int numYCells, int* numCells, char* rule, int ruleSize)
+{
+    *numCells = 0;
+    if (rule != NULL && ruleSize > 0)
+        rule[0] = '\0';
+
+    char* Text = ReadPatternFile(path);
+    if (Text == NULL)
+    {
+        printf("LoadPattern %s fail\n", path);
+        return NULL;
+    }
+
+    std::vector<PatternCell> Live;
+    bool isParsed = IsRleText(Text) ? ParseRle(Text, Live, rule, ruleSize) : ParsePlaintext(Text, Live);
+    free(Text);
+    if (isParsed != true)
+        return NULL;
+
+    int width = 0, height = 0;
+    for (const PatternCell& cell : Live)
+    {
+        width = cell.x + 1 > width ? cell.x + 1 : width;
+        height = cell.y + 1 > height ? cell.y + 1 : height;
+    }
+
+    int* CellXY = (int*)malloc((Live.size() + 1) * 2 * sizeof(int));
+    if (CellXY == NULL)
+    {
+        printf("LoadPattern malloc fail\n");
+        return NULL;
+    }
+    int xOffset = (numXCells - width) / 2;
+    int yOffset = (numYCells - height) / 2;
+    int numCut = 0;
+    for (const PatternCell& cell : Live)
+    {
+        int xidx = cell.x + xOffset;
+        int yidx = cell.y + yOffset;
+        if (xidx < 0 || xidx >= numXCells || yidx < 0 || yidx >= numYCells)
+        {
+            numCut++;
+            continue;
+        }
+        CellXY[2 * *numCells] = xidx;
+        CellXY[2 * *numCells + 1] = yidx;
+        (*numCells)++;
+    }
+
+    printf("Pattern : %s, %dx%d, %d cells", path, width, height, (int)Live.size());
+    if (numCut > 0)
+        printf(", %d beyond the board", numCut);
+    printf("\n");
+
+    return CellXY;
+}
+
+bool LoadPattern(const char* path, bool* Cells, int numXCells, int numYCells, char* rule, int ruleSize)
+{
+    int numCells;
+    int* CellXY = LoadPatternCells(path, numXCells, numYCells, &numCells, rule, ruleSize);
+    if (CellXY == NULL)
+        return false;
+
+    memset(Cells, 0, (size_t)numXCells * numYCells * sizeof(bool));
+    for (int cellIdx = 0; cellIdx < numCells; cellIdx++)
+        Cells[CellXY[2 * cellIdx] + (size_t)numXCells * CellXY[2 * cellIdx + 1]] = true;
+    free(CellXY);
+
+    return true;
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+/*
+Loads a pattern file centred on the board, cells beyond the board are cut off.
+RLE (.rle) : "x = 3, y = 3, rule = B3/S23" header, b dead, o live, $ next row, ! end, counts in front,
+the states A..X of multi-state RLE are live. Plaintext (.cells) : ! comments, . dead, O or * live.
+The rule of the RLE header is copied to rule when it is not NULL, "" when the file has none.
+*/
+bool LoadPattern(const char* path, bool* Cells, int numXCells, int numYCells, char* rule, int ruleSize);
+
+// Same without a board : the live cells as x, y pairs on the board, malloc'd, freed by the caller
+int* LoadPatternCells(const char* path, int numXCells, int numYCells, int* numCells, char* rule, int ruleSize);
@@ -0,0 +1,468 @@
+#include "Rule.h"
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+Rule CurrentRule = { RULE_B3, RULE_S23, 2, false, 1, NEIGHBOURHOOD_MOORE, false, 0, 0, 0, 0, false, 0, 0 };
+static RuleKernelType CurrentRuleKernel = RULE_KERNEL_LIFE;
+
+/*
+Hensel notation : the configurations of n neighbours up to rotation and reflection are named by letters,
+in this order, n and 8 - n have the same number of them and the one of 8 - n is the complement.
+*/
+static const char HenselLetters[] = "cekainyqjrtwz";
+static const int HenselNumLetters[9] = { 0, 2, 6, 10, 13, 10, 6, 2, 0 };
+static const int HenselFirst[10] = { 0, 1, 3, 9, 19, 32, 42, 48, 50, HENSEL_CONFIGS };
+
+/*
+One neighbourhood of every letter of 1 to 4 neighbours, as in the tables of Golly, in index512 bits of
+LifeTable.h transposed : NW 1, N 2, NE 4, W 8, E 32, SW 64, S 128, SE 256.
+The transposition is a reflection, so every rotation and reflection of them gives the same classes.
+*/
+static const uint16_t HenselMasks[5][13] =
+{
+    { 0 },
+    { 1, 2 },
+    { 5, 10, 33, 3, 40, 68 },
+    { 69, 42, 98, 11, 7, 13, 97, 70, 14, 41 },
+    { 325, 170, 99, 15, 45, 71, 101, 102, 106, 43, 105, 78, 108 },
+};
+
+// Configuration of every 3x3 neighbourhood, built at compile time from the masks above
+struct HenselTable
+{
+    uint8_t Config[512];
+
+    static constexpr int Transform(int index512, int symmetry)
+    {
+        int result = 0;
+        for (int bit = 0; bit < 9; bit++)
+        {
+            int column = bit / 3, row = bit % 3;
+            for (int turn = 0; turn < (symmetry & 3); turn++)
+            {
+                int tmp = column;
+                column = 2 - row;
+                row = tmp;
+            }
+            if (symmetry & 4)
+                column = 2 - column;
+            result |= ((index512 >> bit) & 1) << (3 * column + row);
+        }
+        return result;
+    }
+
+    constexpr HenselTable() : Config()
+    {
+        for (int count = 0; count <= 8; count++)
+        {
+            int numConfigs = HenselFirst[count + 1] - HenselFirst[count];
+            for (int letter = 0; letter < numConfigs; letter++)
+            {
+                int mask = count <= 4 ? HenselMasks[count][letter] : HenselMasks[8 - count][letter] ^ 0x1EF;
+                for (int symmetry = 0; symmetry < 8; symmetry++)
+                {
+                    int index512 = Transform(mask, symmetry);
+                    Config[index512] = (uint8_t)(HenselFirst[count] + letter);
+                    Config[index512 | 0x10] = (uint8_t)(HenselFirst[count] + letter);
+                }
+            }
+        }
+    }
+};
+
+static constexpr HenselTable Hensel;
+
+// Configurations of n neighbours
+static inline uint64_t GetHenselConfigs(int count)
+{
+    return ((1ULL << HenselFirst[count + 1]) - 1) & ~((1ULL << HenselFirst[count]) - 1);
+}
+
+/*
+Digits 0-8 into a count mask and the Hensel configurations, stops at the first other character.
+A digit alone takes every configuration of the count, "2ak" only the letters, "2-ak" all but the letters.
+A Hensel letter the count does not have is an error, NULL : "8c" is not 8 neighbours followed by C states.
+*/
+static const char* ParseCounts(const char* rulestring, const char* str, uint16_t* mask, uint64_t* hensel)
+{
+    *mask = 0;
+    *hensel = 0;
+    while (*str >= '0' && *str <= '8')
+    {
+        int count = *str - '0';
+        str++;
+        bool isNegated = *str == '-';
+        if (isNegated)
+            str++;
+
+        uint64_t letters = 0;
+        while (*str >= 'a' && *str <= 'z')
+        {
+            int letter = 0;
+            while (letter < HenselNumLetters[count] && HenselLetters[letter] != *str)
+                letter++;
+            if (letter == HenselNumLetters[count] && strchr(HenselLetters, *str) != NULL)
+            {
+                printf("ParseRule %s : no letter %c for %d neighbours\n", rulestring, *str, count);
+                return NULL;
+            }
+            if (letter == HenselNumLetters[count])
+                break;
+            letters |= 1ULL << (HenselFirst[count] + letter);
+            str++;
+        }
+
+        uint64_t configs = GetHenselConfigs(count);
+        if (letters != 0)
+            configs = isNegated ? configs & ~letters : letters;
+        *hensel |= configs;
+        if (configs != 0)
+            *mask |= 1 << count;
+    }
+    return str;
+}
+
+// Decimal number of states, 0 when there is none
+static const char* ParseStates(const char* str, int* numStates)
+{
+    *numStates = 0;
+    while (*str >= '0' && *str <= '9' && *numStates <= RULE_MAX_STATES)
+    {
+        *numStates = *numStates * 10 + (*str - '0');
+        str++;
+    }
+    return str;
+}
+
+// Decimal number or interval "min..max"
+static const char* ParseInterval(const char* str, int* min, int* max)
+{
+    char* end = NULL;
+    *min = (int)strtol(str, &end, 10);
+    *max = *min;
+    if (end[0] == '.' && end[1] == '.')
+        *max = (int)strtol(end + 2, &end, 10);
+    return end;
+}
+
+/*
+Larger than Life in the notation of Golly : "R5,C0,M1,S34..58,B34..45,NM" (any case), C and M may be left out.
+C0 and C2 are two states, Larger than Life Generations rules are not supported.
+*/
+static bool ParseRangeRule(const char* rulestring, Rule* rule)
+{
+    const char* str = rulestring;
+    int range = 0, numStates = 0, centre = 0;
+    int birthMin = -1, birthMax = -1, survivalMin = -1, survivalMax = -1;
+    Neighbourhood neighbourhood = NEIGHBOURHOOD_MOORE;
+
+    while (*str != '\0')
+    {
+        char letter = (char)toupper(*str);
+        char* end = NULL;
+        if (letter == 'R')
+            range = (int)strtol(str + 1, &end, 10);
+        else if (letter == 'C')
+            numStates = (int)strtol(str + 1, &end, 10);
+        else if (letter == 'M')
+            centre = (int)strtol(str + 1, &end, 10);
+        else if (letter == 'S')
+            end = (char*)ParseInterval(str + 1, &survivalMin, &survivalMax);
+        else if (letter == 'B')
+            end = (char*)ParseInterval(str + 1, &birthMin, &birthMax);
+        else if (letter == 'N' && (toupper(str[1]) == 'M' || toupper(str[1]) == 'N'))
+        {
+            neighbourhood = toupper(str[1]) == 'M' ? NEIGHBOURHOOD_MOORE : NEIGHBOURHOOD_VON_NEUMANN;
+            end = (char*)str + 2;
+        }
+        if (end == NULL || end == str + 1)
+        {
+            printf("ParseRule %s fail\n", rulestring);
+            return false;
+        }
+        str = *end == ',' ? end + 1 : end;
+    }
+
+    if (range < 1 || range > RULE_MAX_RANGE || numStates > 2 || (centre != 0 && centre != 1) ||
+        birthMin < 0 || survivalMin < 0 || birthMax < birthMin || survivalMax < survivalMin)
+    {
+        printf("ParseRule %s : range 1 to %d, C0 or C2, M0 or M1, S and B intervals\n", rulestring, RULE_MAX_RANGE);
+        return false;
+    }
+    if (birthMin == 0)
+    {
+        printf("ParseRule %s : B0 rules are not supported\n", rulestring);
+        return false;
+    }
+
+    rule->birth = 0;
+    rule->survival = 0;
+    rule->numStates = 2;
+    rule->hasRange = true;
+    rule->range = range;
+    rule->neighbourhood = neighbourhood;
+    rule->hasCentre = centre == 1;
+    rule->birthMin = birthMin;
+    rule->birthMax = birthMax;
+    rule->survivalMin = survivalMin;
+    rule->survivalMax = survivalMax;
+    rule->isIsotropic = false;
+    rule->birthHensel = 0;
+    rule->survivalHensel = 0;
+    return true;
+}
+
+/*
+Accepts "B3/S23" (any case, either order) and the older "23/3" survival/birth notation,
+Generations rules add the number of states as "B2/S/C3" (or G3) and "/2/3",
+hexagonal and von Neumann rules end with H or V as in Golly : "B2/S34H", "B2/S013V", "34/2H".
+*/
+bool ParseRule(const char* rulestring, Rule* rule)
+{
+    const char* str = rulestring;
+    uint16_t birth = 0, survival = 0;
+    uint64_t birthHensel = 0, survivalHensel = 0;
+    int numStates = 2;
+    Neighbourhood neighbourhood = NEIGHBOURHOOD_MOORE;
+
+    if (toupper(*str) == 'R' && str[1] >= '0' && str[1] <= '9')
+        return ParseRangeRule(rulestring, rule);
+
+    if (toupper(*str) == 'B' || toupper(*str) == 'S')
+    {
+        bool hasBirth = false, hasSurvival = false, hasStates = false, hasShape = false;
+        while (*str != '\0')
+        {
+            char letter = (char)toupper(*str);
+            if (letter == 'B' && hasBirth == false)
+            {
+                str = ParseCounts(rulestring, str + 1, &birth, &birthHensel);
+                if (str == NULL)
+                    return false;
+                hasBirth = true;
+            }
+            else if (letter == 'S' && hasSurvival == false)
+            {
+                str = ParseCounts(rulestring, str + 1, &survival, &survivalHensel);
+                if (str == NULL)
+                    return false;
+                hasSurvival = true;
+            }
+            else if ((letter == 'C' || letter == 'G') && hasStates == false)
+            {
+                str = ParseStates(str + 1, &numStates);
+                hasStates = true;
+            }
+            else if ((letter == 'H' || letter == 'V') && hasShape == false)
+            {
+                neighbourhood = letter == 'H' ? NEIGHBOURHOOD_HEXAGONAL : NEIGHBOURHOOD_VON_NEUMANN;
+                hasShape = true;
+                str++;
+            }
+            else
+            {
+                break;
+            }
+            if (*str == '/')
+                str++;
+        }
+        if (*str != '\0' || hasBirth == false || hasSurvival == false)
+        {
+            printf("ParseRule %s fail\n", rulestring);
+            return false;
+        }
+    }
+    else
+    {
+        str = ParseCounts(rulestring, str, &survival, &survivalHensel);
+        if (str == NULL)
+            return false;
+        if (*str != '/')
+        {
+            printf("ParseRule %s fail\n", rulestring);
+            return false;
+        }
+        str = ParseCounts(rulestring, str + 1, &birth, &birthHensel);
+        if (str == NULL)
+            return false;
+        if (toupper(*str) == 'H' || toupper(*str) == 'V')
+        {
+            neighbourhood = toupper(*str) == 'H' ? NEIGHBOURHOOD_HEXAGONAL : NEIGHBOURHOOD_VON_NEUMANN;
+            str++;
+        }
+        if (*str == '/')
+            str = ParseStates(str + 1, &numStates);
+        if (*str != '\0')
+        {
+            printf("ParseRule %s fail\n", rulestring);
+            return false;
+        }
+    }
+
+    if (numStates < 2 || numStates > RULE_MAX_STATES)
+    {
+        printf("ParseRule %s : 2 to %d states\n", rulestring, RULE_MAX_STATES);
+        return false;
+    }
+
+    if (birth & 1)
+    {
+        printf("ParseRule %s : B0 rules are not supported\n", rulestring);
+        return false;
+    }
+
+    // Totalistic when every count takes all of its configurations
+    bool isIsotropic = false;
+    for (int count = 0; count <= 8; count++)
+    {
+        uint64_t configs = GetHenselConfigs(count);
+        isIsotropic |= (((birth >> count) & 1) && (birthHensel & configs) != configs) ||
+            (((survival >> count) & 1) && (survivalHensel & configs) != configs);
+    }
+    if (isIsotropic && numStates > 2)
+    {
+        printf("ParseRule %s : Generations rules in Hensel notation are not supported\n", rulestring);
+        return false;
+    }
+
+    if (neighbourhood != NEIGHBOURHOOD_MOORE)
+    {
+        int maxCount = neighbourhood == NEIGHBOURHOOD_HEXAGONAL ? 6 : 4;
+        if (((birth | survival) >> (maxCount + 1)) != 0 || isIsotropic || numStates > 2)
+        {
+            printf("ParseRule %s : counts 0 to %d without letters or states\n", rulestring, maxCount);
+            return false;
+        }
+    }
+
+    rule->birth = birth;
+    rule->survival = survival;
+    rule->numStates = numStates;
+    rule->hasRange = false;
+    rule->range = 1;
+    rule->neighbourhood = neighbourhood;
+    rule->hasCentre = false;
+    rule->birthMin = 0;
+    rule->birthMax = 0;
+    rule->survivalMin = 0;
+    rule->survivalMax = 0;
+    rule->isIsotropic = isIsotropic;
+    rule->birthHensel = birthHensel;
+    rule->survivalHensel = survivalHensel;
+    return true;
+}
+
+void FormatRule(Rule rule, char* rulestring, size_t size)
+{
+    size_t len = 0;
+    if (size == 0)
+        return;
+
+    if (rule.hasRange)
+    {
+        snprintf(rulestring, size, "R%d,C0,M%d,S%d..%d,B%d..%d,N%c", rule.range, rule.hasCentre ? 1 : 0,
+            rule.survivalMin, rule.survivalMax, rule.birthMin, rule.birthMax,
+            rule.neighbourhood == NEIGHBOURHOOD_MOORE ? 'M' : 'N');
+        return;
+    }
+
+    for (int part = 0; part < 2; part++)
+    {
+        uint16_t mask = part == 0 ? rule.birth : rule.survival;
+        uint64_t hensel = part == 0 ? rule.birthHensel : rule.survivalHensel;
+        if (len + 1 < size)
+            rulestring[len++] = part == 0 ? 'B' : 'S';
+        for (int count = 0; count <= 8; count++)
+        {
+            if (((mask >> count) & 1) && len + 1 < size)
+                rulestring[len++] = (char)('0' + count);
+            if (((mask >> count) & 1) == 0 || rule.isIsotropic != true)
+                continue;
+
+            // The shorter of the letters and "-" with the missing letters
+            uint64_t configs = GetHenselConfigs(count);
+            int numTaken = 0;
+            for (int letter = 0; letter < HenselNumLetters[count]; letter++)
+                numTaken += (hensel >> (HenselFirst[count] + letter)) & 1;
+            if ((hensel & configs) == configs)
+                continue;
+            bool isNegated = numTaken * 2 > HenselNumLetters[count];
+            if (isNegated && len + 1 < size)
+                rulestring[len++] = '-';
+            for (int letter = 0; letter < HenselNumLetters[count]; letter++)
+            {
+                bool isTaken = (hensel >> (HenselFirst[count] + letter)) & 1;
+                if (isTaken != isNegated && len + 1 < size)
+                    rulestring[len++] = HenselLetters[letter];
+            }
+        }
+        if (part == 0 && len + 1 < size)
+            rulestring[len++] = '/';
+    }
+    if (rule.neighbourhood != NEIGHBOURHOOD_MOORE && len + 1 < size)
+        rulestring[len++] = rule.neighbourhood == NEIGHBOURHOOD_HEXAGONAL ? 'H' : 'V';
+    rulestring[len] = '\0';
+    if (rule.numStates > 2)
+        snprintf(rulestring + len, size - len, "/C%d", rule.numStates);
+}
+
+// Next state of the centre of a 3x3 neighbourhood in the index512 bits of LifeTable.h, for every Moore B/S rule
+bool IsNextLive512(Rule rule, int index512)
+{
+    bool islive = (index512 >> 4) & 1;
+    if (rule.isIsotropic)
+        return ((islive ? rule.survivalHensel : rule.birthHensel) >> Hensel.Config[index512]) & 1;
+
+    int numNeighbours = 0;
+    for (int bit = 0; bit < 9; bit++)
+    {
+        if (bit != 4)
+            numNeighbours += (index512 >> bit) & 1;
+    }
+    return IsNextLive(rule, islive, numNeighbours);
+}
+
+bool SetRule(const char* rulestring)
+{
+    Rule rule;
+    if (ParseRule(rulestring, &rule) != true)
+        return false;
+
+    CurrentRule = rule;
+    if (rule.numStates > 2 || rule.hasRange || rule.isIsotropic || rule.neighbourhood != NEIGHBOURHOOD_MOORE)
+        CurrentRuleKernel = RULE_KERNEL_RUNTIME;
+    else if (rule.birth == RULE_B3 && rule.survival == RULE_S23)
+        CurrentRuleKernel = RULE_KERNEL_LIFE;
+    else if (rule.birth == RULE_B36 && rule.survival == RULE_S23)
+        CurrentRuleKernel = RULE_KERNEL_HIGHLIFE;
+    else if (rule.birth == RULE_B3678 && rule.survival == RULE_S34678)
+        CurrentRuleKernel = RULE_KERNEL_DAYNIGHT;
+    else
+        CurrentRuleKernel = RULE_KERNEL_RUNTIME;
+
+    return true;
+}
+
+RuleKernelType GetRuleKernel()
+{
+    return CurrentRuleKernel;
+}
+
+const char* GetRuleKernelName(RuleKernelType type)
+{
+    switch (type)
+    {
+    case RULE_KERNEL_RUNTIME:
+        return "Runtime";
+    case RULE_KERNEL_LIFE:
+        return "Life";
+    case RULE_KERNEL_HIGHLIFE:
+        return "HighLife";
+    case RULE_KERNEL_DAYNIGHT:
+        return "Day & Night";
+    default:
+        return "Unknown";
+    }
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Count masks : bit n is set when n live neighbours give birth / let a live cell survive
+#define RULE_B3 0x008
+#define RULE_B36 0x048
+#define RULE_B3678 0x1C8
+#define RULE_S23 0x00C
+#define RULE_S34678 0x1D8
+#define RULE_RUNTIME 0xFFFF     // template argument : read the mask from the current rule
+#define RULE_MAX_STATES 256
+#define RULE_MAX_RANGE 50
+#define HENSEL_CONFIGS 51       // neighbourhoods up to rotation and reflection
+
+enum Neighbourhood
+{
+    NEIGHBOURHOOD_MOORE,        // square of (2R + 1)^2 cells
+    NEIGHBOURHOOD_VON_NEUMANN,  // diamond |dx| + |dy| <= R
+    NEIGHBOURHOOD_HEXAGONAL,    // 6 neighbours of a hex grid in offset rows, B/S rules only
+    NUM_NEIGHBOURHOODS
+};
+
+/*
+Life-like rule in B/S notation, B3/S23 is Conway's Game of Life.
+The rule is chosen once at startup with SetRule, before any engine is created; engines that
+memoize or skip unchanged regions assume it never changes while they run.
+Rules with B0 are refused : a dead region would come alive everywhere, which the sparse
+and unbounded engines cannot represent.
+Generations rules (B2/S/C3 is Brian's Brain) add refractory states : a live cell that does not
+survive passes through states 2 .. numStates - 1 before it is dead again, only state 1 counts as a
+live neighbour and only state 0 can give birth. numStates == 2 is a life-like rule.
+Larger than Life rules (R5,C0,M1,S34..58,B34..45,NM is Bosco's Rule) count a range-R neighbourhood
+and replace the masks by count intervals, M1 counts the cell itself.
+Isotropic non-totalistic rules in Hensel notation (B2-a/S12, B3/S2-i34q) depend on the arrangement of
+the neighbours : the masks keep every count that has some configuration, bit k of the Hensel sets is the
+k-th configuration in the order of the notation (0, 1c, 1e, 2c, ...). Kernels that only see counts do not
+run them, the 512 entry tables of IsNextLive512 do.
+Hexagonal and von Neumann B/S rules (B2/S34H, B2/S013V) count 6 or 4 neighbours, only the byte grid and
+the engine of their neighbourhood run them. IsNextLive512 is for Moore rules.
+*/
+struct Rule
+{
+    uint16_t birth;
+    uint16_t survival;
+    int numStates;
+    bool hasRange;      // Larger than Life, the fields below are used instead of the masks
+    int range;
+    Neighbourhood neighbourhood;
+    bool hasCentre;
+    int birthMin, birthMax;
+    int survivalMin, survivalMax;
+    bool isIsotropic;   // Hensel notation with letters, the sets below decide instead of the masks
+    uint64_t birthHensel;
+    uint64_t survivalHensel;
+};
+
+/*
+Rules with a template-specialized kernel, RULE_KERNEL_RUNTIME reads the masks of the current rule.
+Every specialization is instantiated from the same template with the masks as constants, and the
+rule functions match the count against each count of the masks with compares or bit-sliced logic,
+a variable shift of the mask by the count would keep the loops from vectorizing.
+*/
+enum RuleKernelType
+{
+    RULE_KERNEL_RUNTIME,
+    RULE_KERNEL_LIFE,       // B3/S23
+    RULE_KERNEL_HIGHLIFE,   // B36/S23
+    RULE_KERNEL_DAYNIGHT,   // B3678/S34678
+    NUM_RULE_KERNELS
+};
+
+extern Rule CurrentRule;
+
+bool ParseRule(const char* rulestring, Rule* rule);
+void FormatRule(Rule rule, char* rulestring, size_t size);
+bool SetRule(const char* rulestring);
+bool IsNextLive512(Rule rule, int index512);
+RuleKernelType GetRuleKernel();
+const char* GetRuleKernelName(RuleKernelType type);
+
+inline Rule GetRule()
+{
+    return CurrentRule;
+}
+
+inline bool IsNextLive(Rule rule, bool islive, int numNeighbours)
+{
+    return ((islive ? rule.survival : rule.birth) >> numNeighbours) & 1;
+}
+
+/*
+Next state of one cell from its neighbour count, for kernels specialized on Birth / Survival.
+Constant masks OR together one compare per count they hold, which vectorizes, the runtime masks
+are shifted by the count.
+*/
+template <int Birth, int Survival>
+inline uint8_t RuleCell(uint8_t numNeighbours, uint8_t islive, Rule rule)
+{
+    if (Birth == RULE_RUNTIME || Survival == RULE_RUNTIME)
+    {
+        int birth = Birth == RULE_RUNTIME ? rule.birth : Birth;
+        int survival = Survival == RULE_RUNTIME ? rule.survival : Survival;
+        return (((birth >> numNeighbours) & (islive ^ 1)) | ((survival >> numNeighbours) & islive)) & 1;
+    }
+
+    uint8_t born = 0, survive = 0;
+    for (int count = 0; count <= 8; count++)
+    {
+        if ((Birth >> count) & 1)
+            born |= numNeighbours == count;
+        if ((Survival >> count) & 1)
+            survive |= numNeighbours == count;
+    }
+    return (born & (islive ^ 1)) | (survive & islive);
+}
+
+template <>
+inline uint8_t RuleCell<RULE_B3, RULE_S23>(uint8_t numNeighbours, uint8_t islive, Rule rule)
+{
+    return (numNeighbours == 3) | ((numNeighbours == 2) & islive);
+}
+
+/*
+Next state of 64 cells from a bit-sliced neighbour count (s3 s2 s1 s0) and the current cells m.
+Every count of the masks matches (s3 s2 s1 s0) == count, B3/S23 reduces to count 2 or 3 without s0 for survival.
+*/
+template <int Birth, int Survival>
+inline uint64_t RuleWord(uint64_t s0, uint64_t s1, uint64_t s2, uint64_t s3, uint64_t m, Rule rule)
+{
+    int birth = Birth == RULE_RUNTIME ? rule.birth : Birth;
+    int survival = Survival == RULE_RUNTIME ? rule.survival : Survival;
+    uint64_t born = 0, survive = 0;
+
+    for (int count = 0; count <= 8; count++)
+    {
+        if ((((birth | survival) >> count) & 1) == 0)
+            continue;
+        uint64_t match = ((count & 1) ? s0 : ~s0) & ((count & 2) ? s1 : ~s1) &
+            ((count & 4) ? s2 : ~s2) & ((count & 8) ? s3 : ~s3);
+        if ((birth >> count) & 1)
+            born |= match;
+        if ((survival >> count) & 1)
+            survive |= match;
+    }
+    return (born & ~m) | (survive & m);
+}
+
+template <>
+inline uint64_t RuleWord<RULE_B3, RULE_S23>(uint64_t s0, uint64_t s1, uint64_t s2, uint64_t s3, uint64_t m, Rule rule)
+{
+    return s1 & ~s2 & ~s3 & (s0 | m);
+}
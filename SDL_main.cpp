@@ -1,9 +1,14 @@
 #include "SDL_main.h"
+#include "ByteGrid.h"
+#include "LifeEngine.h"
+#include "CycleDetector.h"
+#include "Memory.h"
+#include "Rule.h"
 #include <stdio.h>
+#include <string.h>
 #include <algorithm>
-#include <random>
 
-void RunSDL()
+void RunSDL(int numThreads, Uint64 startGeneration, Uint64 seed, double density)
 {
     SDL_Window* window = NULL;
     SDL_Renderer* renderer = NULL;
@@ -12,11 +17,13 @@ void RunSDL()
     int window_w = WINDOW_W;
     int window_h = WINDOW_H;
 
+    SelectCellKernel();
+
     auto err = InitializedSDL(&window, &renderer, window_w, window_h);
     if (err != 0)
         return;
 
-    err = ExecuteSDL(&renderer, event, window_w, window_h);
+    err = ExecuteSDL(&renderer, event, window_w, window_h, numThreads, startGeneration, seed, density);
     if (err != 0)
         return;
 
@@ -28,7 +35,8 @@ int InitializedSDL(SDL_Window** window, SDL_Renderer** renderer, int width, int
     int window_w = width;
     int window_h = height;
 
-    auto err = SDL_Init(SDL_INIT_EVERYTHING);
+    // Only what the window needs, audio, haptic and joystick stay uninitialized
+    auto err = SDL_Init(SDL_INIT_VIDEO | SDL_INIT_EVENTS);
     if (err != 0)
     {
         printf("SDL_Init fail, Error Code = %d, Desc = %s", err, SDL_GetError());
@@ -71,7 +79,115 @@ void FinalizedSDL(SDL_Window** window, SDL_Renderer** renderer)
     SDL_Quit();
 }
 
-int ExecuteSDL(SDL_Renderer** renderer, SDL_Event& event, int width, int height)
+// Window title with the generation, only updated by engines that jump several generations per frame
+static void SetTitle(SDL_Renderer** renderer, const LifeEngine* engine)
+{
+    char title[128];
+    snprintf(title, sizeof(title), "Conway's Game of Life - %s - Generation %llu (step 2^%d)",
+        GetEngineName(engine->type), (unsigned long long)engine->generation, GetEngineStep(engine));
+    SDL_SetWindowTitle(SDL_RenderGetWindow(*renderer), title);
+}
+
+// Palette of Generations rules : state 1 is CELL_COLOR, refractory states fade from DYING_COLOR to GRID_COLOR
+static SDL_Color GetStateColor(int state, int numStates)
+{
+    if (state == 1)
+        return { CELL_COLOR, CELL_COLOR, CELL_COLOR, 255 };
+
+    int step = state - 2;
+    int numSteps = numStates - 2;
+    return { (Uint8)(DYING_COLOR_R + (GRID_COLOR - DYING_COLOR_R) * step / numSteps),
+        (Uint8)(DYING_COLOR_G + (GRID_COLOR - DYING_COLOR_G) * step / numSteps),
+        (Uint8)(DYING_COLOR_B + (GRID_COLOR - DYING_COLOR_B) * step / numSteps), 255 };
+}
+
+/*
+Draws the cells of every non-zero state in one batch of its palette color.
+StateRects receives the rects grouped by state, StateCounts has RULE_MAX_STATES + 1 entries.
+*/
+static void RenderStates(SDL_Renderer** renderer, const uint8_t* States, const SDL_Rect* CellRects, SDL_Rect* StateRects,
+                         int* StateCounts, int numCells, int numStates)
+{
+    memset(StateCounts, 0, (numStates + 1) * sizeof(int));
+    for (int idx = 0; idx < numCells; idx++)
+    {
+        StateCounts[States[idx] + 1]++;
+    }
+    for (int state = 1; state <= numStates; state++)
+    {
+        StateCounts[state] += StateCounts[state - 1];
+    }
+    // StateCounts[s] is now the first rect of state s
+    for (int idx = 0; idx < numCells; idx++)
+    {
+        StateRects[StateCounts[States[idx]]++] = CellRects[idx];
+    }
+    // and after the fill the first rect of state s + 1
+    for (int state = 1; state < numStates; state++)
+    {
+        SDL_Color color = GetStateColor(state, numStates);
+        SDL_SetRenderDrawColor(*renderer, color.r, color.g, color.b, color.a);
+        SDL_RenderFillRects(*renderer, StateRects + StateCounts[state - 1], StateCounts[state] - StateCounts[state - 1]);
+    }
+}
+
+/*
+Hexagonal rules draw offset rows : odd rows sit half a cell to the right and every cell is a hexagon of width
+grid_size reaching grid_size / 6 into the rows above and below, so the rows tile the plane with a pitch of grid_size.
+HexIndices holds the 4 triangles of every hexagon once, HexVertices receives the 6 corners of every live cell.
+*/
+static void SetHexIndices(int* HexIndices, int numCells)
+{
+    for (int idx = 0; idx < numCells; idx++)
+    {
+        for (int tri = 0; tri < 4; tri++)
+        {
+            HexIndices[idx * 12 + tri * 3] = idx * 6;
+            HexIndices[idx * 12 + tri * 3 + 1] = idx * 6 + tri + 1;
+            HexIndices[idx * 12 + tri * 3 + 2] = idx * 6 + tri + 2;
+        }
+    }
+}
+
+static void RenderHexCells(SDL_Renderer** renderer, const bool* Cells, SDL_Vertex* HexVertices, const int* HexIndices,
+                           int numXCells, int numYCells, int grid_size)
+{
+    static const float CornerX[6] = { 0.5f, 1.0f, 1.0f, 0.5f, 0.0f, 0.0f };
+    static const float CornerY[6] = { -1.0f / 6, 1.0f / 6, 5.0f / 6, 7.0f / 6, 5.0f / 6, 1.0f / 6 };
+    float size = (float)grid_size;
+    int numLive = 0;
+
+    for (int yidx = 0; yidx < numYCells; yidx++)
+    {
+        float left = (yidx & 1) ? size / 2 : 0.0f;
+        for (int xidx = 0; xidx < numXCells; xidx++)
+        {
+            if (Cells[xidx + numXCells * yidx] != true)
+                continue;
+            SDL_Vertex* corner = HexVertices + numLive * 6;
+            for (int idx = 0; idx < 6; idx++)
+            {
+                corner[idx].position = { left + size * (xidx + CornerX[idx]), size * (yidx + CornerY[idx]) };
+                corner[idx].color = { CELL_COLOR, CELL_COLOR, CELL_COLOR, 255 };
+                corner[idx].tex_coord = { 0.0f, 0.0f };
+            }
+            numLive++;
+        }
+    }
+    SDL_RenderGeometry(*renderer, NULL, HexVertices, numLive * 6, HexIndices, numLive * 12);
+}
+
+// Column under a mouse position, the rows of a hex grid are offset by half a cell
+static int GetMouseCell(int x, int y, int grid_size, int numXCells, bool isHexagonal)
+{
+    int yidx = y / grid_size;
+    if (isHexagonal && (yidx & 1))
+        x = std::max(x - grid_size / 2, 0);
+    return std::min(x / grid_size, numXCells - 1) + numXCells * yidx;
+}
+
+int ExecuteSDL(SDL_Renderer** renderer, SDL_Event& event, int width, int height, int numThreads, Uint64 startGeneration,
+    Uint64 seed, double density)
 {
     int window_w = width;
     int window_h = height;
@@ -124,13 +240,95 @@ int ExecuteSDL(SDL_Renderer** renderer, SDL_Event& event, int width, int height)
         return -1;
     }
 
-    if (SetCells(Cells, numXCells, numYCells, grid_size) != true)
+    // Generations rules keep every cell state for the palette, Cells then only follows state 1
+    int numStates = GetRule().numStates;
+    bool isMultiState = numStates > 2;
+    uint8_t* States = NULL;
+    SDL_Rect* StateRects = NULL;
+    int* StateCounts = NULL;
+    if (isMultiState)
+    {
+        States = (uint8_t*)malloc(numXCells * numYCells * sizeof(uint8_t));
+        StateRects = (SDL_Rect*)malloc(numXCells * numYCells * sizeof(SDL_Rect));
+        StateCounts = (int*)malloc((RULE_MAX_STATES + 1) * sizeof(int));
+        if (States == NULL || StateRects == NULL || StateCounts == NULL)
+        {
+            printf("States malloc fail\n");
+            return -1;
+        }
+    }
+
+    if (SetCells(Cells, numXCells, numYCells, seed, density, NULL) != true)
     {
         printf("SetCells fail\n");
         return -1;
     }
+    printf("Seed : %llu, density %.3f\n", (unsigned long long)seed, density);
+    if (isMultiState)
+    {
+        for (int idx = 0; idx < numXCells * numYCells; idx++)
+            States[idx] = Cells[idx];
+    }
     SetCellRects(CellRects, numXCells, numYCells, grid_size);
 
+    bool isHexagonal = GetRule().neighbourhood == NEIGHBOURHOOD_HEXAGONAL;
+    SDL_Vertex* HexVertices = NULL;
+    int* HexIndices = NULL;
+    if (isHexagonal)
+    {
+        HexVertices = (SDL_Vertex*)malloc((size_t)numXCells * numYCells * 6 * sizeof(SDL_Vertex));
+        HexIndices = (int*)malloc((size_t)numXCells * numYCells * 12 * sizeof(int));
+        if (HexVertices == NULL || HexIndices == NULL)
+        {
+            printf("Hex malloc fail\n");
+            return -1;
+        }
+        SetHexIndices(HexIndices, numXCells * numYCells);
+    }
+
+    ThreadPool pool;
+    if (InitThreadPool(&pool, numThreads > 0 ? numThreads : SDL_GetCPUCount()) != true)
+    {
+        printf("InitThreadPool fail\n");
+        return -1;
+    }
+    printf("Threads : %d\n", pool.numThreads);
+
+    // Starting at a later generation jumps there with HashLife, rules it does not run take the next engine that does
+    LifeEngineType engineType = startGeneration > 0 ? ENGINE_HASHLIFE : ENGINE_BITBOARD;
+    while (IsEngineSupported(engineType) != true)
+        engineType = (LifeEngineType)((engineType + 1) % NUM_ENGINES);
+    LifeEngine engine;
+    if (InitEngine(&engine, engineType, numXCells, numYCells, &pool) != true)
+    {
+        printf("InitEngine fail\n");
+        return -1;
+    }
+    if (isMultiState)
+        LoadEngineStates(&engine, States);
+    else
+        LoadEngine(&engine, Cells);
+    bool isEdited = false;
+    Topology topology = TOPOLOGY_CLAMPED;
+    printf("Engine : %s\n", GetEngineName(engineType));
+    if (startGeneration > 0)
+    {
+        if (AdvanceEngine(&engine, startGeneration) != true)
+            return -1;
+        StoreEngine(&engine, Cells);
+        if (isMultiState)
+            StoreEngineStates(&engine, States);
+        SetTitle(renderer, &engine);
+    }
+
+    // Settled boards of bounded engines replay their cycle from memory, the detector hashes the states of
+    // Generations rules. The window of HashLife or the chunked plane can repeat while the plane beyond it does not
+    uint8_t* Board = isMultiState ? States : (uint8_t*)Cells;
+    CycleDetector cycle;
+    if (InitCycleDetector(&cycle, numXCells * numYCells, true) != true)
+        return -1;
+    ResetCycleDetector(&cycle, Board);
+
     // Main Loop
     while (isRunning)
     {
@@ -163,7 +361,67 @@ int ExecuteSDL(SDL_Renderer** renderer, SDL_Event& event, int width, int height)
                 }
                 break;
             case SDLK_TAB:
-                SetCells(Cells, numXCells, numYCells, grid_size);
+                seed = GetRandomSeed();
+                SetCells(Cells, numXCells, numYCells, seed, density, &pool);
+                printf("Seed : %llu, density %.3f\n", (unsigned long long)seed, density);
+                if (isMultiState)
+                {
+                    for (int idx = 0; idx < numXCells * numYCells; idx++)
+                        States[idx] = Cells[idx];
+                }
+                isEdited = true;
+                break;
+            case SDLK_e:
+            {
+                Uint64 generation = engine.generation;
+                FreeEngine(&engine);
+                do
+                {
+                    engineType = (LifeEngineType)((engineType + 1) % NUM_ENGINES);
+                } while (IsEngineSupported(engineType) != true);
+                if (InitEngine(&engine, engineType, numXCells, numYCells, &pool) != true)
+                    return -1;
+                if (isMultiState)
+                    LoadEngineStates(&engine, States);
+                else
+                    LoadEngine(&engine, Cells);
+                engine.generation = generation;
+                isEdited = true;
+                printf("Engine : %s\n", GetEngineName(engineType));
+                if (SetEngineTopology(&engine, topology) != true)
+                {
+                    topology = TOPOLOGY_CLAMPED;
+                    printf("Topology : %s\n", GetTopologyName(topology));
+                }
+                SetTitle(renderer, &engine);
+            }
+                break;
+            case SDLK_t:
+            {
+                Topology nextTopology = (Topology)((topology + 1) % NUM_TOPOLOGIES);
+                if (SetEngineTopology(&engine, nextTopology))
+                {
+                    topology = nextTopology;
+                    isEdited = true;
+                    printf("Topology : %s\n", GetTopologyName(topology));
+                }
+            }
+                break;
+            case SDLK_EQUALS:
+            case SDLK_KP_PLUS:
+                if (SetEngineStep(&engine, GetEngineStep(&engine) + 1))
+                {
+                    SetTitle(renderer, &engine);
+                    isEdited = true;
+                }
+                break;
+            case SDLK_MINUS:
+            case SDLK_KP_MINUS:
+                if (SetEngineStep(&engine, GetEngineStep(&engine) - 1))
+                {
+                    SetTitle(renderer, &engine);
+                    isEdited = true;
+                }
                 break;
             default:
                 break;
@@ -174,16 +432,20 @@ int ExecuteSDL(SDL_Renderer** renderer, SDL_Event& event, int width, int height)
             {
             case SDL_BUTTON_LEFT:
             {
-                int xidx = event.button.x / grid_size;
-                int yidx = event.button.y / grid_size;
-                Cells[xidx + numXCells * yidx] = true;
+                int idx = GetMouseCell(event.button.x, event.button.y, grid_size, numXCells, isHexagonal);
+                Cells[idx] = true;
+                if (isMultiState)
+                    States[idx] = 1;
+                isEdited = true;
             }
                 break;
             case SDL_BUTTON_RIGHT:
             {
-                int xidx = event.button.x / grid_size;
-                int yidx = event.button.y / grid_size;
-                Cells[xidx + numXCells * yidx] = false;
+                int idx = GetMouseCell(event.button.x, event.button.y, grid_size, numXCells, isHexagonal);
+                Cells[idx] = false;
+                if (isMultiState)
+                    States[idx] = 0;
+                isEdited = true;
             }
                 break;
             default:
@@ -195,16 +457,20 @@ int ExecuteSDL(SDL_Renderer** renderer, SDL_Event& event, int width, int height)
             {
             case SDL_BUTTON_LMASK:
             {
-                int xidx = event.motion.x / grid_size;
-                int yidx = event.motion.y / grid_size;
-                Cells[xidx + numXCells * yidx] = true;
+                int idx = GetMouseCell(event.motion.x, event.motion.y, grid_size, numXCells, isHexagonal);
+                Cells[idx] = true;
+                if (isMultiState)
+                    States[idx] = 1;
+                isEdited = true;
             }
                 break;
             case SDL_BUTTON_RMASK:
             {
-                int xidx = event.motion.x / grid_size;
-                int yidx = event.motion.y / grid_size;
-                Cells[xidx + numXCells * yidx] = false;
+                int idx = GetMouseCell(event.motion.x, event.motion.y, grid_size, numXCells, isHexagonal);
+                Cells[idx] = false;
+                if (isMultiState)
+                    States[idx] = 0;
+                isEdited = true;
             }
                 break;
             default:
@@ -218,25 +484,75 @@ int ExecuteSDL(SDL_Renderer** renderer, SDL_Event& event, int width, int height)
         // Update
         if (isUpdate)
         {
-            if (UpdateCell(Cells, numXCells, numYCells) != true)
-                return -1;
+            if (isEdited)
+            {
+                if (isMultiState)
+                    LoadEngineStates(&engine, States);
+                else
+                    LoadEngine(&engine, Cells);
+                ResetCycleDetector(&cycle, Board);
+                isEdited = false;
+            }
+            if (cycle.isConfirmed)
+            {
+                // The engine stays where the capture ended, edits load the board back into it
+                memcpy(Board, ReplayCycle(&cycle), numXCells * numYCells);
+                if (isMultiState)
+                {
+                    for (int idx = 0; idx < numXCells * numYCells; idx++)
+                        Cells[idx] = States[idx] == 1;
+                }
+                engine.generation += 1ULL << GetEngineStep(&engine);
+            }
+            else
+            {
+                if (StepEngine(&engine) != true)
+                    return -1;
+                StoreEngine(&engine, Cells);
+                if (isMultiState)
+                    StoreEngineStates(&engine, States);
+                if (IsEngineBounded(engineType))
+                {
+                    UpdateCycleDetector(&cycle, Board);
+                    if (cycle.isConfirmed)
+                        printf("Cycle : period %llu, replayed from memory\n",
+                            (unsigned long long)cycle.period << GetEngineStep(&engine));
+                }
+            }
+            if (GetEngineStep(&engine) > 0)
+                SetTitle(renderer, &engine);
         }
         
         // Render
         SDL_RenderClear(*renderer);
         SDL_RenderCopy(*renderer, texture, NULL, NULL);
 
-        SDL_SetRenderDrawColor(*renderer, GridColor, GridColor, GridColor, 255);
-        SDL_RenderDrawLines(*renderer, XLinePoints, numXPoints);
-        SDL_RenderDrawLines(*renderer, YLinePoints, numYPoints);
+        // The square grid lines do not follow the offset rows of a hex grid
+        if (isHexagonal != true)
+        {
+            SDL_SetRenderDrawColor(*renderer, GridColor, GridColor, GridColor, 255);
+            SDL_RenderDrawLines(*renderer, XLinePoints, numXPoints);
+            SDL_RenderDrawLines(*renderer, YLinePoints, numYPoints);
+        }
 
-        SDL_SetRenderDrawColor(*renderer, CELL_COLOR, CELL_COLOR, CELL_COLOR, 255);
-        for (int yidx = 0; yidx < numYCells; yidx++)
+        if (isHexagonal)
+        {
+            RenderHexCells(renderer, Cells, HexVertices, HexIndices, numXCells, numYCells, grid_size);
+        }
+        else if (isMultiState)
         {
-            for (int xidx = 0; xidx < numXCells; xidx++)
+            RenderStates(renderer, States, CellRects, StateRects, StateCounts, numXCells * numYCells, numStates);
+        }
+        else
+        {
+            SDL_SetRenderDrawColor(*renderer, CELL_COLOR, CELL_COLOR, CELL_COLOR, 255);
+            for (int yidx = 0; yidx < numYCells; yidx++)
             {
-                if (Cells[xidx + numXCells * yidx])
-                    SDL_RenderFillRect(*renderer, &CellRects[xidx + numXCells * yidx]);
+                for (int xidx = 0; xidx < numXCells; xidx++)
+                {
+                    if (Cells[xidx + numXCells * yidx])
+                        SDL_RenderFillRect(*renderer, &CellRects[xidx + numXCells * yidx]);
+                }
             }
         }
         SDL_RenderPresent(*renderer);
@@ -250,6 +566,10 @@ int ExecuteSDL(SDL_Renderer** renderer, SDL_Event& event, int width, int height)
 
     }
 
+    FreeCycleDetector(&cycle);
+    FreeEngine(&engine);
+    PrintThreadPoolStats(&pool);
+    FreeThreadPool(&pool);
     if (texture != NULL)
        SDL_DestroyTexture(texture);
     if (XLinePoints != NULL)
@@ -260,6 +580,16 @@ int ExecuteSDL(SDL_Renderer** renderer, SDL_Event& event, int width, int height)
         free(Cells);
     if (CellRects != NULL)
         free(CellRects);
+    if (States != NULL)
+        free(States);
+    if (StateRects != NULL)
+        free(StateRects);
+    if (StateCounts != NULL)
+        free(StateCounts);
+    if (HexVertices != NULL)
+        free(HexVertices);
+    if (HexIndices != NULL)
+        free(HexIndices);
 
     return 0;
 }
@@ -302,100 +632,6 @@ void SetGridLine(SDL_Renderer** renderer, SDL_Point* XLinePoints, SDL_Point* YLi
     }
 }
 
-bool UpdateCell(bool* Cells, int numXCells, int numYCells)
-{
-    bool* tmpCells = (bool*)malloc(numXCells * numYCells * sizeof(bool));
-    if (tmpCells == NULL)
-    {
-        printf("UpdateCell fail\n");
-        return false;
-    }
-
-    for (int yidx = 0; yidx < numYCells; yidx++)
-    {
-        for (int xidx = 0; xidx < numXCells; xidx++)
-        {
-            tmpCells[xidx + numXCells * yidx] = CheckRule(Cells, xidx, yidx, numXCells, numYCells);
-        }
-    }
-
-    memcpy(Cells, tmpCells, numXCells * numYCells * sizeof(bool));
-
-    if (tmpCells != NULL)
-    {
-        free(tmpCells);
-    }
-
-    return true;
-}
-
-/*
-Any live cell with fewer than two live neighbours dies, as if by underpopulation.
-Any live cell with two or three live neighbours lives on to the next generation.
-Any live cell with more than three live neighbours dies, as if by overpopulation.
-Any dead cell with exactly three live neighbours becomes a live cell, as if by reproduction.
-*/
-bool CheckRule(bool* Cells, int xidx, int yidx, int width, int height)
-{
-    // Window Boundary Rule
-    int xm = std::max(xidx - 1, 0);
-    int x0 = xidx;
-    int xp = std::min(xidx + 1, width - 1);
-    int ym = std::max(yidx - 1, 0);
-    int y0 = yidx;
-    int yp = std::min(yidx + 1, height - 1);
-    bool islive = Cells[x0 + width * y0];
-
-    int numNeighbours = Cells[xm + width * ym] +
-        Cells[x0 + width * ym] +
-        Cells[xp + width * ym] +
-        Cells[xm + width * y0] +
-        Cells[xp + width * y0] +
-        Cells[xm + width * yp] +
-        Cells[x0 + width * yp] +
-        Cells[xp + width * yp];
-
-    if (islive == true)
-    {
-        if (numNeighbours < 2 || numNeighbours > 3)
-            return false;
-        else
-            return true;
-    }
-    else
-    {
-        if (numNeighbours == 3)
-            return true;
-        else
-            return false;
-    }
-}
-
-bool SetCells(bool* Cells, int numXCells, int numYCells, int grid_size)
-{
-    if (Cells != NULL)
-    {
-        memset(Cells, 0, numXCells * numYCells * sizeof(bool));
-
-        // Initial Cells Position Randomly
-        std::random_device rd;
-        std::mt19937 mersenne(rd());
-        std::uniform_int_distribution<> coin(0, 1);
-
-        for (int xidx = 0; xidx < numXCells; xidx++)
-        {
-            for (int yidx = 0; yidx < numYCells; yidx++)
-            {
-                Cells[xidx + numXCells * yidx] = coin(mersenne);
-            }
-        }
-
-        return true;
-    }
-    else
-        return false;
-}
-
 void SetCellRects(SDL_Rect* CellRects, int numXCells, int numYCells, int grid_size)
 {
     for (int yidx = 0; yidx < numYCells; yidx++)
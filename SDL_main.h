@@ -1,6 +1,8 @@
 #pragma once
 
 #include <SDL.h>
+#include "CellKernel.h"
+#include "ThreadPool.h"
 
 #define WINDOW_W 1920*2
 #define WINDOW_H 1080*2
@@ -10,15 +12,16 @@
 #define GRID_COLOR 230
 #define CELL_COLOR 100
 #define PAUSE_COLOR 150
+#define DYING_COLOR_R 70     // first refractory state of Generations rules, later ones fade to GRID_COLOR
+#define DYING_COLOR_G 110
+#define DYING_COLOR_B 200
 
 
-void RunSDL();
+void RunSDL(int numThreads, Uint64 startGeneration, Uint64 seed, double density);
 int InitializedSDL(SDL_Window** window, SDL_Renderer** renderer, int width, int height);
 void FinalizedSDL(SDL_Window** window, SDL_Renderer** renderer);
-int ExecuteSDL(SDL_Renderer** renderer, SDL_Event& event, int width, int height);
+int ExecuteSDL(SDL_Renderer** renderer, SDL_Event& event, int width, int height, int numThreads, Uint64 startGeneration,
+    Uint64 seed, double density);
 
 void SetGridLine(SDL_Renderer** renderer, SDL_Point* XLinePoints, SDL_Point* YLinePoints, int window_w, int window_h, int grid_size);
-bool UpdateCell(bool* Cells, int numXCells, int numYCells);
-bool CheckRule(bool* Cells, int xidx, int yidx, int width, int height);
-bool SetCells(bool* Cells, int numXCells, int numYCells, int grid_size);
 void SetCellRects(SDL_Rect* CellRects, int numXCells, int numYCells, int grid_size);
@@ -0,0 +1,491 @@
+#include "SoupSearch.h"
+#include "MultiUniverse.h"
+#include "BitSlice.h"
+#include "Rule.h"
+#include "ByteGrid.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+
+#define SOUP_FILE_VERSION 3      // 3 : soups are SetCells boards
+
+// Seed of the soupIdx-th soup, runs search soups from a random seedBase on so they never search the same ones
+uint64_t GetSoupSeed(uint64_t soupIdx)
+{
+    return GetSeedWord(soupIdx, 0);
+}
+
+// The board of SetCells at the default density, --seed with the recorded seed shows the same soup
+void SetSoupCells(bool* Cells, int numXCells, int numYCells, uint64_t seed)
+{
+    SetCells(Cells, numXCells, numYCells, seed, SEED_DENSITY, NULL);
+}
+
+struct SoupWorker
+{
+    MultiUniverse multi;
+    bool* Cells;
+    uint64_t (*Hashes)[SOUP_MAX_PERIOD];        // per lane, its hashes of the last SOUP_MAX_PERIOD generations
+};
+
+struct SoupChunk
+{
+    SoupWorker* workers;
+    const uint64_t* Zobrist;    // random key per cell, the hash of a lane is the XOR of the keys of its live cells
+    SoupRecord* Results;        // one per soup of the chunk
+    uint64_t firstSoup;         // soup index, seedBase of the run plus the soups before the chunk
+    int numSoups;
+    int maxGenerations;
+};
+
+// Hash and population of all 64 lanes at generation 0, one pass over the live bits
+static void HashLanes(const MultiUniverse* multi, const uint64_t* Zobrist, uint64_t* Hash, uint32_t* Population)
+{
+    memset(Hash, 0, MULTI_UNIVERSE_LANES * sizeof(uint64_t));
+    memset(Population, 0, MULTI_UNIVERSE_LANES * sizeof(uint32_t));
+    for (int yidx = 0; yidx < multi->numYCells; yidx++)
+    {
+        const uint64_t* row = multi->Front + (size_t)multi->stride * (yidx + 1) + 1;
+        const uint64_t* keys = Zobrist + (size_t)multi->numXCells * yidx;
+        for (int xidx = 0; xidx < multi->numXCells; xidx++)
+        {
+            for (uint64_t lanes = row[xidx]; lanes != 0; lanes &= lanes - 1)
+            {
+                int lane = LowestBit(lanes);
+                Hash[lane] ^= keys[xidx];
+                Population[lane]++;
+            }
+        }
+    }
+}
+
+/*
+Hash and population of all 64 lanes after a generation, from those of the generation before : Back still
+holds it, so the XOR of the two words of a cell has one bit per lane where the cell was born or died
+and only those bits are walked. Returns the OR of all the differences, lanes without their bit repeat
+the board of the generation before.
+*/
+static uint64_t UpdateLaneHashes(const MultiUniverse* multi, const uint64_t* Zobrist, uint64_t* Hash,
+                                 uint32_t* Population)
+{
+    uint64_t changed = 0;
+    for (int yidx = 0; yidx < multi->numYCells; yidx++)
+    {
+        const uint64_t* row = multi->Front + (size_t)multi->stride * (yidx + 1) + 1;
+        const uint64_t* last = multi->Back + (size_t)multi->stride * (yidx + 1) + 1;
+        const uint64_t* keys = Zobrist + (size_t)multi->numXCells * yidx;
+        for (int xidx = 0; xidx < multi->numXCells; xidx++)
+        {
+            uint64_t word = row[xidx];
+            uint64_t diff = word ^ last[xidx];
+            changed |= diff;
+            for (; diff != 0; diff &= diff - 1)
+            {
+                int lane = LowestBit(diff);
+                Hash[lane] ^= keys[xidx];
+                Population[lane] += 2 * (uint32_t)((word >> lane) & 1) - 1;     // +1 born, -1 died, no branch
+            }
+        }
+    }
+    return changed;
+}
+
+/*
+64 soups in the lanes of one multi-universe, run until every lane repeats a board of the last
+SOUP_MAX_PERIOD generations or maxGenerations is reached.
+The first repeat of generation g at distance p makes g - p the start of the final cycle.
+*/
+static void RunSoupBatch(void* context, int taskIdx, int threadIdx)
+{
+    const SoupChunk* chunk = (const SoupChunk*)context;
+    SoupWorker* worker = &chunk->workers[threadIdx];
+    MultiUniverse* multi = &worker->multi;
+    SoupRecord* out = chunk->Results + (size_t)taskIdx * MULTI_UNIVERSE_LANES;
+    int numLanes = chunk->numSoups - taskIdx * MULTI_UNIVERSE_LANES;
+    if (numLanes > MULTI_UNIVERSE_LANES)
+        numLanes = MULTI_UNIVERSE_LANES;
+
+    for (int lane = 0; lane < MULTI_UNIVERSE_LANES; lane++)
+    {
+        uint64_t seed = GetSoupSeed(chunk->firstSoup + (uint64_t)taskIdx * MULTI_UNIVERSE_LANES + lane);
+        if (lane < numLanes)
+            SetSoupCells(worker->Cells, multi->numXCells, multi->numYCells, seed);
+        else
+            memset(worker->Cells, 0, (size_t)multi->numXCells * multi->numYCells * sizeof(bool));
+        LoadMultiUniverseLane(multi, lane, worker->Cells);
+        if (lane < numLanes)
+            out[lane] = { seed, (uint32_t)chunk->maxGenerations, 0, 0, 0 };
+    }
+
+    uint64_t Hash[MULTI_UNIVERSE_LANES];
+    uint32_t Population[MULTI_UNIVERSE_LANES];
+    HashLanes(multi, chunk->Zobrist, Hash, Population);
+    for (int lane = 0; lane < MULTI_UNIVERSE_LANES; lane++)
+    {
+        // Slots of generations before 0 repeat generation 0, a match there is found again at period gen
+        for (int slot = 0; slot < SOUP_MAX_PERIOD; slot++)
+            worker->Hashes[lane][slot] = Hash[lane];
+        if (lane < numLanes)
+            out[lane].maxPopulation = Population[lane];
+    }
+
+    uint64_t running = numLanes == MULTI_UNIVERSE_LANES ? ~0ULL : (1ULL << numLanes) - 1;
+    for (int gen = 1; gen <= chunk->maxGenerations && running != 0; gen++)
+    {
+        UpdateMultiUniverse(multi, NULL);
+        uint64_t changed = UpdateLaneHashes(multi, chunk->Zobrist, Hash, Population);
+
+        // Lanes without a difference end with period 1, the others compare their hash to the earlier ones
+        for (uint64_t lanes = running & ~changed; lanes != 0; lanes &= lanes - 1)
+        {
+            int lane = LowestBit(lanes);
+            out[lane].lifespan = gen - 1;
+            out[lane].period = 1;
+            out[lane].population = Population[lane];
+        }
+        running &= changed;
+
+        int maxPeriod = gen < SOUP_MAX_PERIOD ? gen : SOUP_MAX_PERIOD;
+        for (uint64_t lanes = running; lanes != 0; lanes &= lanes - 1)
+        {
+            int lane = LowestBit(lanes);
+            uint64_t* ring = worker->Hashes[lane];
+            if (Population[lane] > out[lane].maxPopulation)
+                out[lane].maxPopulation = Population[lane];
+
+            // Branch free test of the whole ring first, the ordered search only runs on a match
+            bool isMatch = false;
+            for (int slot = 0; slot < SOUP_MAX_PERIOD; slot++)
+                isMatch |= ring[slot] == Hash[lane];
+            for (int period = 2; period <= maxPeriod && isMatch; period++)
+            {
+                if (ring[(gen - period) % SOUP_MAX_PERIOD] == Hash[lane])
+                {
+                    out[lane].lifespan = gen - period;
+                    out[lane].period = period;
+                    out[lane].population = Population[lane];
+                    running &= ~(1ULL << lane);
+                    break;
+                }
+            }
+            ring[gen % SOUP_MAX_PERIOD] = Hash[lane];
+        }
+    }
+
+    for (; running != 0; running &= running - 1)
+        out[LowestBit(running)].population = Population[LowestBit(running)];
+}
+
+// Longest lifespan first, unstable soups (period 0) before stable ones of the same lifespan
+static int CompareLifespan(const void* a, const void* b)
+{
+    const SoupRecord* ra = (const SoupRecord*)a;
+    const SoupRecord* rb = (const SoupRecord*)b;
+    if (ra->lifespan != rb->lifespan)
+        return ra->lifespan > rb->lifespan ? -1 : 1;
+    if ((ra->period == 0) != (rb->period == 0))
+        return ra->period == 0 ? -1 : 1;
+    return ra->seed < rb->seed ? -1 : (ra->seed > rb->seed ? 1 : 0);
+}
+
+/*
+Reads a result file, a missing file is an empty result of the given rule and size.
+Runs and Records receive malloc'ed arrays, freed by the caller.
+*/
+static bool ReadSoupFile(const char* path, SoupFileHeader* header, SoupRun** Runs, SoupRecord** Records,
+                         int numXCells, int numYCells, const char* rule)
+{
+    *Runs = NULL;
+    *Records = NULL;
+    memset(header, 0, sizeof(SoupFileHeader));
+    memcpy(header->magic, "SOUP", 4);
+    header->version = SOUP_FILE_VERSION;
+    header->numXCells = numXCells;
+    header->numYCells = numYCells;
+    snprintf(header->rule, sizeof(header->rule), "%s", rule);
+
+    FILE* file = fopen(path, "rb");
+    if (file == NULL)
+        return true;
+
+    SoupFileHeader fileHeader;
+    bool isRead = fread(&fileHeader, sizeof(fileHeader), 1, file) == 1 && memcmp(fileHeader.magic, "SOUP", 4) == 0 &&
+        fileHeader.version == SOUP_FILE_VERSION;
+    if (isRead && fileHeader.numRuns > 0)
+    {
+        *Runs = (SoupRun*)malloc(fileHeader.numRuns * sizeof(SoupRun));
+        isRead = *Runs != NULL && fread(*Runs, sizeof(SoupRun), fileHeader.numRuns, file) == fileHeader.numRuns;
+    }
+    if (isRead && fileHeader.numRecords > 0)
+    {
+        *Records = (SoupRecord*)malloc(fileHeader.numRecords * sizeof(SoupRecord));
+        isRead = *Records != NULL &&
+            fread(*Records, sizeof(SoupRecord), fileHeader.numRecords, file) == fileHeader.numRecords;
+    }
+    fclose(file);
+    if (isRead != true)
+    {
+        printf("ReadSoupFile %s fail\n", path);
+        free(*Runs);
+        free(*Records);
+        *Runs = NULL;
+        *Records = NULL;
+        return false;
+    }
+
+    fileHeader.rule[sizeof(fileHeader.rule) - 1] = '\0';
+    if (fileHeader.numXCells != (uint32_t)numXCells || fileHeader.numYCells != (uint32_t)numYCells ||
+        strcmp(fileHeader.rule, rule) != 0)
+    {
+        printf("ReadSoupFile %s holds %s soups of %ux%u, not %s of %dx%d\n", path, fileHeader.rule,
+            fileHeader.numXCells, fileHeader.numYCells, rule, numXCells, numYCells);
+        free(*Runs);
+        free(*Records);
+        *Runs = NULL;
+        *Records = NULL;
+        return false;
+    }
+
+    *header = fileHeader;
+    return true;
+}
+
+// Sorts, drops records of the same seed and writes the file
+static bool WriteSoupFile(const char* path, SoupFileHeader* header, const SoupRun* Runs, SoupRecord* Records,
+                          size_t numRecords)
+{
+    qsort(Records, numRecords, sizeof(SoupRecord), CompareLifespan);
+    // The same seed always gives the same record, so duplicates are next to each other after the sort
+    size_t numUnique = 0;
+    for (size_t idx = 0; idx < numRecords; idx++)
+    {
+        if (numUnique == 0 || CompareLifespan(&Records[numUnique - 1], &Records[idx]) != 0)
+            Records[numUnique++] = Records[idx];
+    }
+    header->numRecords = numUnique;
+
+    FILE* file = fopen(path, "wb");
+    if (file == NULL)
+    {
+        printf("WriteSoupFile %s fail\n", path);
+        return false;
+    }
+    bool isWritten = fwrite(header, sizeof(SoupFileHeader), 1, file) == 1 &&
+        fwrite(Runs, sizeof(SoupRun), header->numRuns, file) == header->numRuns &&
+        fwrite(Records, sizeof(SoupRecord), numUnique, file) == numUnique;
+    isWritten &= fclose(file) == 0;
+    if (isWritten != true)
+        printf("WriteSoupFile %s fail\n", path);
+    return isWritten;
+}
+
+// Appends count records to a malloc'ed array of *numRecords / *maxRecords
+static bool AppendRecords(SoupRecord** Records, size_t* numRecords, size_t* maxRecords, const SoupRecord* src, size_t count)
+{
+    if (count == 0)
+        return true;
+    if (*numRecords + count > *maxRecords)
+    {
+        size_t maxNew = *maxRecords * 2 > *numRecords + count ? *maxRecords * 2 : *numRecords + count;
+        SoupRecord* grown = (SoupRecord*)realloc(*Records, maxNew * sizeof(SoupRecord));
+        if (grown == NULL)
+        {
+            printf("AppendRecords realloc fail\n");
+            return false;
+        }
+        *Records = grown;
+        *maxRecords = maxNew;
+    }
+    memcpy(*Records + *numRecords, src, count * sizeof(SoupRecord));
+    *numRecords += count;
+    return true;
+}
+
+// Appends count runs to the malloc'ed array of header->numRuns
+static bool AppendRuns(SoupRun** Runs, SoupFileHeader* header, const SoupRun* src, size_t count)
+{
+    SoupRun* grown = (SoupRun*)realloc(*Runs, (header->numRuns + count) * sizeof(SoupRun));
+    if (grown == NULL)
+    {
+        printf("AppendRuns realloc fail\n");
+        return false;
+    }
+    memcpy(grown + header->numRuns, src, count * sizeof(SoupRun));
+    *Runs = grown;
+    header->numRuns += count;
+    return true;
+}
+
+// Soup index ranges in common, the differences wrap around like the indices
+static bool IsRunOverlap(const SoupRun* a, const SoupRun* b)
+{
+    return (a->numSoups > 0 && b->numSoups > 0) &&
+        (b->seedBase - a->seedBase < a->numSoups || a->seedBase - b->seedBase < b->numSoups);
+}
+
+static void PrintSoupRecords(const SoupFileHeader* header, const SoupRecord* Records, size_t numRecords)
+{
+    printf("%s soups of %ux%u : %llu searched, %llu recorded\n", header->rule, header->numXCells, header->numYCells,
+        (unsigned long long)header->numSoups, (unsigned long long)header->numRecords);
+    for (size_t idx = 0; idx < numRecords && idx < 10; idx++)
+    {
+        const SoupRecord* record = &Records[idx];
+        if (record->period == 0)
+            printf("  seed %016llx  unstable after %u generations  population %u  max %u\n",
+                (unsigned long long)record->seed, record->lifespan, record->population, record->maxPopulation);
+        else
+            printf("  seed %016llx  lifespan %6u  period %2u  population %u  max %u\n",
+                (unsigned long long)record->seed, record->lifespan, record->period, record->population,
+                record->maxPopulation);
+    }
+}
+
+/*
+Searches numSoups random soups of numXCells x numYCells on every thread without a window and merges
+the soups of lifespan SOUP_MIN_LIFESPAN or more, and the unstable ones, into the result file at path.
+The soups run with the current rule on the clamped board of CheckRule, 64 per multi-universe.
+*/
+bool RunSoupSearch(uint64_t numSoups, int numXCells, int numYCells, int maxGenerations, int numThreads, const char* path)
+{
+    char rule[64];
+    FormatRule(GetRule(), rule, sizeof(rule));
+
+    SoupFileHeader header;
+    SoupRun* Runs = NULL;
+    SoupRecord* Records = NULL;
+    if (ReadSoupFile(path, &header, &Runs, &Records, numXCells, numYCells, rule) != true)
+        return false;
+    size_t numRecords = header.numRecords;
+    size_t maxRecords = numRecords;
+
+    ThreadPool pool;
+    if (InitThreadPool(&pool, numThreads) != true)
+    {
+        printf("InitThreadPool fail\n");
+        free(Runs);
+        free(Records);
+        return false;
+    }
+
+    size_t numCells = (size_t)numXCells * numYCells;
+    uint64_t* Zobrist = (uint64_t*)malloc(numCells * sizeof(uint64_t));
+    SoupRecord* Results = (SoupRecord*)malloc(SOUP_CHUNK * sizeof(SoupRecord));
+    SoupWorker* workers = (SoupWorker*)calloc(pool.numThreads, sizeof(SoupWorker));
+    bool isReady = Zobrist != NULL && Results != NULL && workers != NULL;
+    for (int thread = 0; isReady && thread < pool.numThreads; thread++)
+    {
+        workers[thread].Cells = (bool*)malloc(numCells * sizeof(bool));
+        workers[thread].Hashes = (uint64_t(*)[SOUP_MAX_PERIOD])malloc(
+            MULTI_UNIVERSE_LANES * SOUP_MAX_PERIOD * sizeof(uint64_t));
+        isReady = workers[thread].Cells != NULL && workers[thread].Hashes != NULL &&
+            InitMultiUniverse(&workers[thread].multi, numXCells, numYCells);
+    }
+
+    if (isReady)
+    {
+        for (size_t idx = 0; idx < numCells; idx++)
+            Zobrist[idx] = GetSeedWord(0x5A0B5A0B5A0B5A0BULL, idx);
+
+        SoupRun run = { GetRandomSeed(), numSoups };
+        printf("Soup search : %llu soups of %dx%d from soup %016llx, %d threads\n", (unsigned long long)numSoups,
+            numXCells, numYCells, (unsigned long long)run.seedBase, pool.numThreads);
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t done = 0; done < numSoups && isReady; )
+        {
+            int count = numSoups - done < SOUP_CHUNK ? (int)(numSoups - done) : SOUP_CHUNK;
+            SoupChunk chunk = { workers, Zobrist, Results, run.seedBase + done, count, maxGenerations };
+            RunThreadPool(&pool, RunSoupBatch, &chunk, (count + MULTI_UNIVERSE_LANES - 1) / MULTI_UNIVERSE_LANES);
+
+            for (int idx = 0; idx < count && isReady; idx++)
+            {
+                if (Results[idx].lifespan >= SOUP_MIN_LIFESPAN || Results[idx].period == 0)
+                    isReady = AppendRecords(&Records, &numRecords, &maxRecords, &Results[idx], 1);
+            }
+            done += count;
+
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            printf("  %llu soups, %.0f soups/s, %zu recorded\n", (unsigned long long)done, done / seconds, numRecords);
+        }
+        header.numSoups += numSoups;
+        isReady = isReady && AppendRuns(&Runs, &header, &run, 1);
+    }
+
+    bool isDone = isReady && WriteSoupFile(path, &header, Runs, Records, numRecords);
+    if (isDone)
+        PrintSoupRecords(&header, Records, header.numRecords);
+
+    for (int thread = 0; workers != NULL && thread < pool.numThreads; thread++)
+    {
+        FreeMultiUniverse(&workers[thread].multi);
+        free(workers[thread].Cells);
+        free(workers[thread].Hashes);
+    }
+    free(workers);
+    free(Results);
+    free(Zobrist);
+    free(Runs);
+    free(Records);
+    FreeThreadPool(&pool);
+
+    return isDone;
+}
+
+/*
+Adds the soups of otherPath into path, both files have to be of the same rule and size.
+Files with a soup in common, copies or files merged before, are refused as their soups would count twice.
+*/
+bool MergeSoupFile(const char* path, const char* otherPath)
+{
+    // The rule and size come from the header of the other file
+    SoupFileHeader other;
+    FILE* file = fopen(otherPath, "rb");
+    if (file == NULL || fread(&other, sizeof(other), 1, file) != 1)
+    {
+        printf("MergeSoupFile %s fail\n", otherPath);
+        if (file != NULL)
+            fclose(file);
+        return false;
+    }
+    fclose(file);
+    char rule[sizeof(other.rule)];
+    memcpy(rule, other.rule, sizeof(rule));
+    rule[sizeof(rule) - 1] = '\0';
+    int numXCells = other.numXCells, numYCells = other.numYCells;
+
+    SoupRun* OtherRuns = NULL;
+    SoupRecord* OtherRecords = NULL;
+    if (ReadSoupFile(otherPath, &other, &OtherRuns, &OtherRecords, numXCells, numYCells, rule) != true)
+        return false;
+
+    SoupFileHeader header;
+    SoupRun* Runs = NULL;
+    SoupRecord* Records = NULL;
+    bool isDone = ReadSoupFile(path, &header, &Runs, &Records, numXCells, numYCells, rule);
+    for (uint64_t runIdx = 0; isDone && runIdx < header.numRuns; runIdx++)
+    {
+        for (uint64_t otherIdx = 0; isDone && otherIdx < other.numRuns; otherIdx++)
+        {
+            if (IsRunOverlap(&Runs[runIdx], &OtherRuns[otherIdx]))
+            {
+                printf("MergeSoupFile %s already holds soups of %s\n", path, otherPath);
+                isDone = false;
+            }
+        }
+    }
+
+    size_t numRecords = header.numRecords;
+    size_t maxRecords = numRecords;
+    isDone = isDone && AppendRecords(&Records, &numRecords, &maxRecords, OtherRecords, other.numRecords) &&
+        AppendRuns(&Runs, &header, OtherRuns, other.numRuns);
+    header.numSoups += other.numSoups;
+    isDone = isDone && WriteSoupFile(path, &header, Runs, Records, numRecords);
+    if (isDone)
+        PrintSoupRecords(&header, Records, header.numRecords);
+
+    free(Runs);
+    free(Records);
+    free(OtherRuns);
+    free(OtherRecords);
+    return isDone;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <stdint.h>
+
+#define SOUP_SIZE 32                // soup board width and height
+#define SOUP_MAX_GENERATIONS 50000  // soups still running after this are recorded as unstable
+#define SOUP_MAX_PERIOD 64          // longest cycle that counts as stable
+#define SOUP_MIN_LIFESPAN 1000      // shorter soups are only counted, not recorded
+#define SOUP_CHUNK 65536            // soups per round of the thread pool
+#define SOUP_FILE "soups.bin"
+
+/*
+One recorded soup, lifespan is the first generation of its final cycle of length period.
+period 0 : still running at the generation limit, lifespan is the limit.
+*/
+struct SoupRecord
+{
+    uint64_t seed;
+    uint32_t lifespan;
+    uint32_t population;    // at lifespan + period
+    uint32_t maxPopulation;
+    uint32_t period;
+};
+
+/*
+Soups searched by one run : soup indices seedBase .. seedBase + numSoups - 1, every run draws a
+random seedBase so runs from empty files or copies of the same file search different soups.
+*/
+struct SoupRun
+{
+    uint64_t seedBase;
+    uint64_t numSoups;
+};
+
+/*
+Result file : this header, numRuns runs and numRecords records sorted by lifespan, longest first,
+in host byte order. numSoups counts every soup searched, the sum of the runs.
+Files only merge with the same rule and board size and no soup index range in common.
+*/
+struct SoupFileHeader
+{
+    char magic[4];          // "SOUP"
+    uint32_t version;
+    uint32_t numXCells;
+    uint32_t numYCells;
+    char rule[64];
+    uint64_t numSoups;
+    uint64_t numRecords;
+    uint64_t numRuns;
+};
+
+uint64_t GetSoupSeed(uint64_t soupIdx);
+void SetSoupCells(bool* Cells, int numXCells, int numYCells, uint64_t seed);
+bool RunSoupSearch(uint64_t numSoups, int numXCells, int numYCells, int maxGenerations, int numThreads, const char* path);
+bool MergeSoupFile(const char* path, const char* otherPath);
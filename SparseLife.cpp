@@ -0,0 +1,249 @@
+#include "SparseLife.h"
+#include "Memory.h"
+#include "Rule.h"
+#include <stdio.h>
+#include <string.h>
+
+bool InitSparseLife(SparseLife* sl, int numXCells, int numYCells)
+{
+    memset(sl, 0, sizeof(SparseLife));
+    sl->numXCells = numXCells;
+    sl->numYCells = numYCells;
+    sl->maxLive = SPARSE_MIN_CELLS;
+
+    sl->Live = (SparseCell*)LifeAlloc(sl->maxLive * sizeof(SparseCell));
+    sl->NextLive = (SparseCell*)LifeAlloc(sl->maxLive * sizeof(SparseCell));
+    sl->Columns = (SparseColumn*)LifeAlloc(numXCells * sizeof(SparseColumn));
+    if (sl->Live == NULL || sl->NextLive == NULL || sl->Columns == NULL)
+    {
+        printf("SparseLife LifeAlloc fail\n");
+        FreeSparseLife(sl);
+        return false;
+    }
+
+    return true;
+}
+
+void FreeSparseLife(SparseLife* sl)
+{
+    LifeFree(sl->Live);
+    LifeFree(sl->NextLive);
+    LifeFree(sl->Columns);
+    sl->Live = NULL;
+    sl->NextLive = NULL;
+    sl->Columns = NULL;
+}
+
+// Keeps the contents of both lists, numNext cells of NextLive are in use
+static bool GrowSparseLife(SparseLife* sl, size_t minLive, size_t numNext)
+{
+    if (minLive <= sl->maxLive)
+        return true;
+
+    size_t maxLive = sl->maxLive * 2 > minLive ? sl->maxLive * 2 : minLive;
+    SparseCell* Live = (SparseCell*)LifeAlloc(maxLive * sizeof(SparseCell));
+    SparseCell* NextLive = (SparseCell*)LifeAlloc(maxLive * sizeof(SparseCell));
+    if (Live == NULL || NextLive == NULL)
+    {
+        printf("GrowSparseLife fail\n");
+        LifeFree(Live);
+        LifeFree(NextLive);
+        return false;
+    }
+    memcpy(Live, sl->Live, sl->numLive * sizeof(SparseCell));
+    memcpy(NextLive, sl->NextLive, numNext * sizeof(SparseCell));
+
+    LifeFree(sl->Live);
+    LifeFree(sl->NextLive);
+    sl->Live = Live;
+    sl->NextLive = NextLive;
+    sl->maxLive = maxLive;
+    return true;
+}
+
+// [*begin, *end) receives the cells of row y, searching forward from index from
+static void FindRow(const SparseLife* sl, size_t from, int y, size_t* begin, size_t* end)
+{
+    size_t idx = from;
+    while (idx < sl->numLive && sl->Live[idx].y < y)
+        idx++;
+    *begin = idx;
+    while (idx < sl->numLive && sl->Live[idx].y == y)
+        idx++;
+    *end = idx;
+}
+
+/*
+Merges the rows ym, y, yp (sorted by x) into one column list, weight is the number of the
+three rows that have the column live. Clamped rows at the top and bottom are the centre row twice.
+*/
+static int MergeRows(const SparseLife* sl, size_t from, int ym, int y, int yp)
+{
+    size_t begin[3], end[3];
+    FindRow(sl, from, ym, &begin[0], &end[0]);
+    FindRow(sl, from, y, &begin[1], &end[1]);
+    FindRow(sl, from, yp, &begin[2], &end[2]);
+
+    int numColumns = 0;
+    while (true)
+    {
+        int x = sl->numXCells;
+        for (int row = 0; row < 3; row++)
+        {
+            if (begin[row] < end[row] && sl->Live[begin[row]].x < x)
+                x = sl->Live[begin[row]].x;
+        }
+        if (x == sl->numXCells)
+            break;
+
+        SparseColumn* column = &sl->Columns[numColumns++];
+        column->x = x;
+        column->weight = 0;
+        column->isLive = false;
+        for (int row = 0; row < 3; row++)
+        {
+            if (begin[row] < end[row] && sl->Live[begin[row]].x == x)
+            {
+                column->weight++;
+                column->isLive |= row == 1;
+                begin[row]++;
+            }
+        }
+    }
+
+    return numColumns;
+}
+
+// Column x within the 3 columns from Columns[first], x is at most 2 above Columns[first].x
+static inline const SparseColumn* GetColumn(const SparseColumn* Columns, int numColumns, int first, int x)
+{
+    for (int idx = first; idx < numColumns && idx < first + 3; idx++)
+    {
+        if (Columns[idx].x == x)
+            return &Columns[idx];
+    }
+    return NULL;
+}
+
+// Appends the live cells of output row y to NextLive
+static size_t UpdateRow(SparseLife* sl, int numColumns, int y, size_t numNext)
+{
+    const SparseColumn* Columns = sl->Columns;
+    Rule rule = GetRule();
+    int lastX = -1;
+    int first = 0;
+
+    for (int idx = 0; idx < numColumns; idx++)
+    {
+        int xBegin = Columns[idx].x > 0 ? Columns[idx].x - 1 : 0;
+        int xEnd = Columns[idx].x < sl->numXCells - 1 ? Columns[idx].x + 1 : sl->numXCells - 1;
+        for (int x = xBegin > lastX + 1 ? xBegin : lastX + 1; x <= xEnd; x++)
+        {
+            // Window Boundary Rule
+            int xm = x > 0 ? x - 1 : 0;
+            int xp = x < sl->numXCells - 1 ? x + 1 : sl->numXCells - 1;
+            while (Columns[first].x < xm)
+                first++;
+
+            const SparseColumn* west = GetColumn(Columns, numColumns, first, xm);
+            const SparseColumn* centre = GetColumn(Columns, numColumns, first, x);
+            const SparseColumn* east = GetColumn(Columns, numColumns, first, xp);
+            bool isLive = centre != NULL && centre->isLive;
+            int numNeighbours = (west != NULL ? west->weight : 0) + (centre != NULL ? centre->weight : 0) +
+                (east != NULL ? east->weight : 0) - isLive;
+
+            if (IsNextLive(rule, isLive, numNeighbours))
+            {
+                sl->NextLive[numNext].x = x;
+                sl->NextLive[numNext].y = y;
+                numNext++;
+            }
+        }
+        lastX = xEnd;
+    }
+
+    return numNext;
+}
+
+bool UpdateSparseLife(SparseLife* sl)
+{
+    if (sl->Live == NULL || sl->NextLive == NULL)
+    {
+        printf("UpdateSparseLife fail\n");
+        return false;
+    }
+
+    int lastRow = sl->numYCells - 1;
+    int lastY = -1;
+    size_t from = 0;    // first cell of row y - 1
+    size_t numNext = 0;
+
+    // Every live row r gives the output rows r - 1, r, r + 1
+    for (size_t idx = 0; idx < sl->numLive; )
+    {
+        int r = sl->Live[idx].y;
+        int yBegin = r > 0 ? r - 1 : 0;
+        int yEnd = r < lastRow ? r + 1 : lastRow;
+        for (int y = yBegin > lastY + 1 ? yBegin : lastY + 1; y <= yEnd; y++)
+        {
+            // Window Boundary Rule
+            int ym = y > 0 ? y - 1 : 0;
+            int yp = y < lastRow ? y + 1 : lastRow;
+            while (from < sl->numLive && sl->Live[from].y < ym)
+                from++;
+
+            if (GrowSparseLife(sl, numNext + sl->numXCells, numNext) != true)
+                return false;
+            int numColumns = MergeRows(sl, from, ym, y, yp);
+            numNext = UpdateRow(sl, numColumns, y, numNext);
+        }
+        lastY = yEnd;
+
+        while (idx < sl->numLive && sl->Live[idx].y == r)
+            idx++;
+    }
+
+    SparseCell* tmp = sl->Live;
+    sl->Live = sl->NextLive;
+    sl->NextLive = tmp;
+    sl->numLive = numNext;
+
+    return true;
+}
+
+void LoadSparseLife(SparseLife* sl, const bool* Cells)
+{
+    size_t numCells = (size_t)sl->numXCells * sl->numYCells;
+    size_t numLive = 0;
+    for (size_t idx = 0; idx < numCells; idx++)
+    {
+        numLive += Cells[idx];
+    }
+
+    sl->numLive = 0;
+    if (GrowSparseLife(sl, numLive, 0) != true)
+        return;
+
+    for (int yidx = 0; yidx < sl->numYCells; yidx++)
+    {
+        const bool* src = Cells + (size_t)sl->numXCells * yidx;
+        for (int xidx = 0; xidx < sl->numXCells; xidx++)
+        {
+            if (src[xidx])
+            {
+                sl->Live[sl->numLive].x = xidx;
+                sl->Live[sl->numLive].y = yidx;
+                sl->numLive++;
+            }
+        }
+    }
+}
+
+void StoreSparseLife(const SparseLife* sl, bool* Cells)
+{
+    memset(Cells, 0, (size_t)sl->numXCells * sl->numYCells * sizeof(bool));
+    for (size_t idx = 0; idx < sl->numLive; idx++)
+    {
+        Cells[sl->Live[idx].x + (size_t)sl->numXCells * sl->Live[idx].y] = true;
+    }
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SPARSE_MIN_CELLS 4096
+
+struct SparseCell
+{
+    int x;
+    int y;
+};
+
+// Live cells of one row of the merged neighbourhood, weight counts the input rows it is live in
+struct SparseColumn
+{
+    int x;
+    int weight;
+    bool isLive;    // live in the centre row
+};
+
+/*
+Live-cell list (as in the Life 1.06 format) : only the coordinates of live cells, sorted by row then column.
+A generation is one pass over the list : for every output row the three input rows are merged into
+column weights and the candidates x-1, x, x+1 of every column are counted from them, so the cost
+scales with the population instead of the area.
+Window Boundary Rule : same clamping as CheckRule, an edge row or column is merged in twice.
+*/
+struct SparseLife
+{
+    int numXCells;
+    int numYCells;
+    SparseCell* Live;       // current generation, sorted by (y, x)
+    SparseCell* NextLive;   // next generation, swapped with Live
+    size_t numLive;
+    size_t maxLive;         // capacity of Live and NextLive
+    SparseColumn* Columns;  // merge buffer of one output row, numXCells
+};
+
+bool InitSparseLife(SparseLife* sl, int numXCells, int numYCells);
+void FreeSparseLife(SparseLife* sl);
+bool UpdateSparseLife(SparseLife* sl);
+
+void LoadSparseLife(SparseLife* sl, const bool* Cells);
+void StoreSparseLife(const SparseLife* sl, bool* Cells);
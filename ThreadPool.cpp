@@ -0,0 +1,306 @@
+#include "ThreadPool.h"
+#include "Memory.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+
+/*
+Per-thread deque for RunThreadPoolStealing. Tasks are plain indices, so a deque is a range
+[begin, end) packed into one atomic word : the owner pops from begin, thieves split off the
+upper half, and both are a single compare-exchange.
+*/
+struct alignas(64) ThreadSlot
+{
+    std::atomic<uint64_t> range{ 0 };
+    double runBusy = 0.0;       // seconds spent in tasks during the current run
+    double totalBusy = 0.0;
+    double totalIdle = 0.0;
+};
+
+struct ThreadPoolState
+{
+    std::vector<std::thread> workers;
+    ThreadSlot* slots = nullptr;    // LifeAlloc'd, new[] only honours alignas(64) from C++17 on
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    unsigned long long runIdx = 0;  // bumped for every RunThreadPool call
+    int numBusy = 0;
+    bool isQuit = false;
+
+    ThreadTask task = nullptr;
+    void* context = nullptr;
+    int numTasks = 0;
+    bool isStealing = false;
+    std::atomic<int> nextTask{ 0 };
+};
+
+static inline uint64_t PackRange(uint32_t begin, uint32_t end)
+{
+    return ((uint64_t)end << 32) | begin;
+}
+
+static void RunTask(ThreadPoolState* state, int taskIdx, int threadIdx)
+{
+    auto start = std::chrono::steady_clock::now();
+    state->task(state->context, taskIdx, threadIdx);
+    auto stop = std::chrono::steady_clock::now();
+
+    state->slots[threadIdx].runBusy += std::chrono::duration<double>(stop - start).count();
+}
+
+static bool PopTask(ThreadSlot* slot, int* taskIdx)
+{
+    uint64_t range = slot->range.load();
+    for (;;)
+    {
+        uint32_t begin = (uint32_t)range, end = (uint32_t)(range >> 32);
+        if (begin >= end)
+            return false;
+        if (slot->range.compare_exchange_weak(range, PackRange(begin + 1, end)))
+        {
+            *taskIdx = begin;
+            return true;
+        }
+    }
+}
+
+// Takes the upper half of a victim's range into the thief's own (empty) deque
+static bool StealTasks(ThreadSlot* victim, ThreadSlot* thief)
+{
+    uint64_t range = victim->range.load();
+    for (;;)
+    {
+        uint32_t begin = (uint32_t)range, end = (uint32_t)(range >> 32);
+        if (begin >= end)
+            return false;
+        uint32_t split = end - (end - begin + 1) / 2;
+        if (victim->range.compare_exchange_weak(range, PackRange(begin, split)))
+        {
+            thief->range.store(PackRange(split, end));
+            return true;
+        }
+    }
+}
+
+static void RunTasks(ThreadPoolState* state, int threadIdx, int numThreads)
+{
+    if (state->isStealing != true)
+    {
+        for (;;)
+        {
+            int taskIdx = state->nextTask.fetch_add(1);
+            if (taskIdx >= state->numTasks)
+                break;
+            RunTask(state, taskIdx, threadIdx);
+        }
+        return;
+    }
+
+    ThreadSlot* own = &state->slots[threadIdx];
+    for (;;)
+    {
+        int taskIdx;
+        while (PopTask(own, &taskIdx))
+        {
+            RunTask(state, taskIdx, threadIdx);
+        }
+
+        bool isStolen = false;
+        for (int i = 1; i < numThreads && isStolen != true; i++)
+        {
+            isStolen = StealTasks(&state->slots[(threadIdx + i) % numThreads], own);
+        }
+        if (isStolen != true)
+            break;
+    }
+}
+
+static void WorkerMain(ThreadPoolState* state, int threadIdx, int numThreads)
+{
+    unsigned long long seenRun = 0;
+
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(state->mutex);
+            state->wake.wait(lock, [&] { return state->isQuit || state->runIdx != seenRun; });
+            if (state->isQuit)
+                return;
+            seenRun = state->runIdx;
+        }
+
+        RunTasks(state, threadIdx, numThreads);
+
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (--state->numBusy == 0)
+            state->done.notify_one();
+    }
+}
+
+bool InitThreadPool(ThreadPool* pool, int numThreads)
+{
+    if (numThreads <= 0)
+        numThreads = GetDefaultThreadCount();
+
+    pool->numThreads = numThreads;
+    pool->state = new (std::nothrow) ThreadPoolState;
+    if (pool->state == NULL)
+    {
+        printf("InitThreadPool fail\n");
+        return false;
+    }
+
+    pool->state->slots = (ThreadSlot*)LifeAlloc(numThreads * sizeof(ThreadSlot));
+    if (pool->state->slots == NULL)
+    {
+        printf("InitThreadPool fail\n");
+        delete pool->state;
+        pool->state = NULL;
+        return false;
+    }
+    for (int threadIdx = 0; threadIdx < numThreads; threadIdx++)
+    {
+        new (&pool->state->slots[threadIdx]) ThreadSlot;
+    }
+    pool->state->workers.reserve(numThreads - 1);
+    for (int threadIdx = 1; threadIdx < numThreads; threadIdx++)
+    {
+        pool->state->workers.emplace_back(WorkerMain, pool->state, threadIdx, numThreads);
+    }
+
+    return true;
+}
+
+void FreeThreadPool(ThreadPool* pool)
+{
+    if (pool->state == NULL)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(pool->state->mutex);
+        pool->state->isQuit = true;
+    }
+    pool->state->wake.notify_all();
+    for (auto& worker : pool->state->workers)
+    {
+        worker.join();
+    }
+
+    LifeFree(pool->state->slots);
+    delete pool->state;
+    pool->state = NULL;
+}
+
+static void RunPool(ThreadPool* pool, ThreadTask task, void* context, int numTasks, bool isStealing)
+{
+    ThreadPoolState* state = pool->state;
+    int numThreads = pool->numThreads;
+    auto start = std::chrono::steady_clock::now();
+
+    for (int threadIdx = 0; threadIdx < numThreads; threadIdx++)
+    {
+        state->slots[threadIdx].runBusy = 0.0;
+    }
+
+    if (numThreads <= 1 || numTasks <= 1)
+    {
+        state->task = task;
+        state->context = context;
+        for (int taskIdx = 0; taskIdx < numTasks; taskIdx++)
+        {
+            RunTask(state, taskIdx, 0);
+        }
+    }
+    else
+    {
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->task = task;
+        state->context = context;
+        state->numTasks = numTasks;
+        state->isStealing = isStealing;
+        state->nextTask = 0;
+        // Contiguous chunks keep neighbouring tiles on the same thread until someone steals
+        for (int threadIdx = 0; threadIdx < numThreads; threadIdx++)
+        {
+            uint32_t begin = (uint32_t)((long long)numTasks * threadIdx / numThreads);
+            uint32_t end = (uint32_t)((long long)numTasks * (threadIdx + 1) / numThreads);
+            state->slots[threadIdx].range.store(PackRange(begin, end));
+        }
+        state->numBusy = (int)state->workers.size();
+        state->runIdx++;
+        lock.unlock();
+        state->wake.notify_all();
+
+        RunTasks(state, 0, numThreads);
+
+        lock.lock();
+        state->done.wait(lock, [&] { return state->numBusy == 0; });
+    }
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    for (int threadIdx = 0; threadIdx < numThreads; threadIdx++)
+    {
+        ThreadSlot* slot = &state->slots[threadIdx];
+        slot->totalBusy += slot->runBusy;
+        slot->totalIdle += elapsed > slot->runBusy ? elapsed - slot->runBusy : 0.0;
+    }
+}
+
+void RunThreadPool(ThreadPool* pool, ThreadTask task, void* context, int numTasks)
+{
+    RunPool(pool, task, context, numTasks, false);
+}
+
+void RunThreadPoolStealing(ThreadPool* pool, ThreadTask task, void* context, int numTasks)
+{
+    RunPool(pool, task, context, numTasks, true);
+}
+
+void GetThreadPoolStats(const ThreadPool* pool, int threadIdx, double* busySeconds, double* idleSeconds)
+{
+    *busySeconds = pool->state->slots[threadIdx].totalBusy;
+    *idleSeconds = pool->state->slots[threadIdx].totalIdle;
+}
+
+void ResetThreadPoolStats(ThreadPool* pool)
+{
+    for (int threadIdx = 0; threadIdx < pool->numThreads; threadIdx++)
+    {
+        pool->state->slots[threadIdx].totalBusy = 0.0;
+        pool->state->slots[threadIdx].totalIdle = 0.0;
+    }
+}
+
+void PrintThreadPoolStats(const ThreadPool* pool)
+{
+    for (int threadIdx = 0; threadIdx < pool->numThreads; threadIdx++)
+    {
+        double busy, idle;
+        GetThreadPoolStats(pool, threadIdx, &busy, &idle);
+        printf("  Thread %3d : busy %8.3fs  idle %8.3fs  (%5.1f%% busy)\n",
+            threadIdx, busy, idle, busy + idle > 0.0 ? 100.0 * busy / (busy + idle) : 0.0);
+    }
+}
+
+int GetDefaultThreadCount()
+{
+    int numThreads = (int)std::thread::hardware_concurrency();
+    return numThreads > 0 ? numThreads : 1;
+}
+
+void GetBandRows(int numRows, int rowAlign, int numBands, int band, int* yBegin, int* yEnd)
+{
+    int numUnits = (numRows + rowAlign - 1) / rowAlign;
+    int unitBegin = (int)((long long)numUnits * band / numBands);
+    int unitEnd = (int)((long long)numUnits * (band + 1) / numBands);
+
+    *yBegin = unitBegin * rowAlign < numRows ? unitBegin * rowAlign : numRows;
+    *yEnd = unitEnd * rowAlign < numRows ? unitEnd * rowAlign : numRows;
+}
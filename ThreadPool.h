@@ -0,0 +1,30 @@
+#pragma once
+
+typedef void (*ThreadTask)(void* context, int taskIdx, int threadIdx);
+
+/*
+Persistent worker pool : threads are created once and sleep between runs.
+RunThreadPool hands out tasks 0..numTasks-1 to the workers and the calling thread,
+and returns when all of them are done. No allocation happens after InitThreadPool.
+RunThreadPoolStealing gives every thread a contiguous share of the tasks in its own deque,
+threads that run out steal half of another thread's remaining tasks.
+*/
+struct ThreadPool
+{
+    int numThreads;                 // workers + calling thread
+    struct ThreadPoolState* state;
+};
+
+bool InitThreadPool(ThreadPool* pool, int numThreads);
+void FreeThreadPool(ThreadPool* pool);
+void RunThreadPool(ThreadPool* pool, ThreadTask task, void* context, int numTasks);
+void RunThreadPoolStealing(ThreadPool* pool, ThreadTask task, void* context, int numTasks);
+
+// Busy = time inside tasks, idle = the rest of each run (stealing, waiting for other threads)
+void GetThreadPoolStats(const ThreadPool* pool, int threadIdx, double* busySeconds, double* idleSeconds);
+void ResetThreadPoolStats(ThreadPool* pool);
+void PrintThreadPoolStats(const ThreadPool* pool);
+int GetDefaultThreadCount();
+
+// Row range of one band, band boundaries are rounded to multiples of rowAlign rows
+void GetBandRows(int numRows, int rowAlign, int numBands, int band, int* yBegin, int* yEnd);
@@ -1,11 +1,46 @@
-
 #include "SDL_main.h"
+#include "BatchMode.h"
+#include "Rule.h"
+#include "ByteGrid.h"
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 int main(int argc, char** argv)
 {
-	RunSDL();
+	// --bench, --soups and --soup-merge run without a window
+	int exitCode = 0;
+	if (RunBatchMode(argc, argv, &exitCode))
+		return exitCode;
+
+	int numThreads = 0;
+	unsigned long long startGeneration = 0;
+	unsigned long long seed = GetRandomSeed();
+	double density = SEED_DENSITY;
+	const char* rulestring = "B3/S23";
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+			numThreads = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--generation") == 0 && i + 1 < argc)
+			startGeneration = strtoull(argv[++i], NULL, 10);
+		else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+			seed = strtoull(argv[++i], NULL, 0);
+		else if (strcmp(argv[i], "--density") == 0 && i + 1 < argc)
+			density = atof(argv[++i]);
+		else if (strcmp(argv[i], "--rule") == 0 && i + 1 < argc)
+			rulestring = argv[++i];
+	}
+
+	if (SetRule(rulestring) != true)
+		return -1;
+	char ruleName[64];
+	FormatRule(GetRule(), ruleName, sizeof(ruleName));
+	printf("Rule : %s (%s kernel)\n", ruleName, GetRuleKernelName(GetRuleKernel()));
+
+	RunSDL(numThreads, startGeneration, seed, density);
 
 	return 0;
 }
\ No newline at end of file